@@ -0,0 +1,110 @@
+#include "headers/distance_table.h"
+#include "headers/domain.h"
+#include "headers/log_duration.h"
+
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include <utility>
+#include <cstdint>
+#include <cstdlib>
+
+using namespace std::string_view_literals;
+
+//Сравнение таблицы расстояний с прежними хранилищами: сетка side x side остановок, расстояние задано до правого и нижнего
+//соседа в одну сторону, запросы идут в обе стороны, как при подсчете длины некольцевого маршрута.
+//Базы сравнения: unordered_map по паре указателей на остановки с исходным StopLengthHasher
+//и unordered_map по паре id, которым справочник пользовался перед DistanceTable; обе ищут обратное направление вторым поиском
+namespace {
+	//Хешер из исходной версии справочника
+	struct StopLengthHasher {
+		size_t operator()(std::pair<const transport::domain::Stop*, const transport::domain::Stop*> key) const {
+			return static_cast<size_t>(key.first->name.size() * key.first->coord.lat * key.first->coord.lng * key.second->name.size() * key.second->coord.lat * key.second->coord.lng);
+		}
+	};
+
+	struct StopIdPairHasher {
+		size_t operator()(std::pair<uint32_t, uint32_t> key) const {
+			return std::hash<uint64_t>{}((static_cast<uint64_t>(key.first) << 32) | key.second);
+		}
+	};
+
+	//Заполняет map и проходит rounds раз по всем перегонам в обе стороны, возвращает контрольную сумму
+	template <typename Map, typename MakeKey>
+	int64_t RunMap(std::string_view name, const std::vector<std::pair<uint32_t, uint32_t>>& segments, int rounds, MakeKey makeKey) {
+		const std::string fillName = std::string(name) + " fill";
+		const std::string lookupName = std::string(name) + " lookup";
+		Map distances;
+		{
+			LOG_DURATION(fillName);
+			for (const auto& [from, to] : segments) {
+				distances[makeKey(from, to)] = static_cast<int>(from % 1000);
+			}
+		}
+		int64_t sum = 0;
+		LOG_DURATION(lookupName);
+		for (int round = 0; round < rounds; ++round) {
+			for (const auto& [from, to] : segments) {
+				for (const auto& [first, second] : { std::pair{ from, to }, std::pair{ to, from } }) {
+					auto it = distances.find(makeKey(first, second));
+					if (it == distances.end()) {
+						it = distances.find(makeKey(second, first));
+					}
+					sum += it != distances.end() ? it->second : 0;
+				}
+			}
+		}
+		return sum;
+	}
+}
+
+//Аргументы: сторона сетки и число проходов запросов
+int main(int argc, char* argv[]) {
+	const uint32_t side = argc > 1 ? static_cast<uint32_t>(std::atoi(argv[1])) : 200;
+	const int rounds = argc > 2 ? std::atoi(argv[2]) : 20;
+
+	std::vector<std::string> names;
+	std::vector<transport::domain::Stop> stops;
+	names.reserve(side * side);
+	stops.reserve(side * side);
+	std::vector<std::pair<uint32_t, uint32_t>> segments;
+	for (uint32_t stop = 0; stop < side * side; ++stop) {
+		names.push_back("Stop " + std::to_string(stop));
+		stops.push_back(transport::domain::Stop{ names.back(), { 55.0 + stop / side * 0.001, 37.0 + stop % side * 0.001 }, stop });
+		if (stop % side + 1 < side) {
+			segments.push_back({ stop, stop + 1 });
+		}
+		if (stop + side < side * side) {
+			segments.push_back({ stop + side, stop });
+		}
+	}
+
+	using StopPair = std::pair<const transport::domain::Stop*, const transport::domain::Stop*>;
+	int64_t hasherSum = RunMap<std::unordered_map<StopPair, int, StopLengthHasher>>("StopLengthHasher map"sv, segments, rounds,
+		[&stops](uint32_t from, uint32_t to) { return StopPair{ &stops[from], &stops[to] }; });
+	int64_t idMapSum = RunMap<std::unordered_map<std::pair<uint32_t, uint32_t>, int, StopIdPairHasher>>("id pair map"sv, segments, rounds,
+		[](uint32_t from, uint32_t to) { return std::pair{ from, to }; });
+
+	transport::catalog::DistanceTable distanceTable;
+	{
+		LOG_DURATION("DistanceTable fill"sv);
+		distanceTable.Reserve(segments.size());
+		for (const auto& [from, to] : segments) {
+			distanceTable.Set(from, to, static_cast<int>(from % 1000));
+		}
+	}
+	int64_t tableSum = 0;
+	{
+		LOG_DURATION("DistanceTable lookup"sv);
+		for (int round = 0; round < rounds; ++round) {
+			for (const auto& [from, to] : segments) {
+				tableSum += distanceTable.Get(from, to);
+				tableSum += distanceTable.Get(to, from);
+			}
+		}
+	}
+	std::cout << "Checksums: "sv << hasherSum << ' ' << idMapSum << ' ' << tableSum << '\n';
+	return 0;
+}
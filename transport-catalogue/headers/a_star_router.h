@@ -0,0 +1,254 @@
+#pragma once
+
+#include "graph.h"
+#include "router.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <optional>
+#include <queue>
+#include <stdexcept>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace graph {
+
+    // Кратчайшие расстояния до опорных вершин (landmarks) и от них, хранятся по вершинам: [vertex * landmarks.size() + i]
+    template <typename Weight>
+    struct LandmarkTable {
+        static_assert(std::numeric_limits<Weight>::has_infinity, "Landmark table needs a weight type with infinity");
+        static constexpr Weight INFINITE_WEIGHT = std::numeric_limits<Weight>::infinity();
+
+        size_t vertex_count = 0;
+        std::vector<VertexId> landmarks;
+        std::vector<Weight> from_landmarks;
+        std::vector<Weight> to_landmarks;
+    };
+
+    // Опорные вершины выбираются по очереди как самые удаленные от уже выбранных
+    template <typename Weight>
+    LandmarkTable<Weight> BuildLandmarkTable(const DirectedWeightedGraph<Weight>& graph, size_t landmark_count) {
+        using Table = LandmarkTable<Weight>;
+        using QueueItem = std::pair<Weight, VertexId>;
+        const size_t vertex_count = graph.GetVertexCount();
+
+        const auto& adjacency = graph.GetAdjacency();
+
+        // Обратный граф в том же формате CSR: для каждой вершины начала входящих ребер
+        std::vector<uint32_t> reverse_offsets(vertex_count + 1, 0);
+        for (const uint32_t target : adjacency.targets) {
+            ++reverse_offsets[target + 1];
+        }
+        for (VertexId vertex = 0; vertex < vertex_count; ++vertex) {
+            reverse_offsets[vertex + 1] += reverse_offsets[vertex];
+        }
+        std::vector<uint32_t> reverse_sources(adjacency.targets.size());
+        std::vector<Weight> reverse_weights(adjacency.targets.size());
+        std::vector<uint32_t> fill(reverse_offsets.begin(), reverse_offsets.end() - 1);
+        for (VertexId vertex = 0; vertex < vertex_count; ++vertex) {
+            for (uint32_t i = adjacency.offsets[vertex]; i < adjacency.offsets[vertex + 1]; ++i) {
+                const uint32_t position = fill[adjacency.targets[i]]++;
+                reverse_sources[position] = static_cast<uint32_t>(vertex);
+                reverse_weights[position] = adjacency.weights[i];
+            }
+        }
+
+        auto compute_distances = [&](VertexId source, bool reversed) {
+            const std::vector<uint32_t>& offsets = reversed ? reverse_offsets : adjacency.offsets;
+            const std::vector<uint32_t>& targets = reversed ? reverse_sources : adjacency.targets;
+            const std::vector<Weight>& weights = reversed ? reverse_weights : adjacency.weights;
+            std::vector<Weight> distances(vertex_count, Table::INFINITE_WEIGHT);
+            std::priority_queue<QueueItem, std::vector<QueueItem>, std::greater<QueueItem>> queue;
+            distances[source] = Weight{};
+            queue.push({ Weight{}, source });
+            while (!queue.empty()) {
+                const auto [weight, vertex] = queue.top();
+                queue.pop();
+                if (weight > distances[vertex]) {
+                    continue;
+                }
+                for (uint32_t i = offsets[vertex]; i < offsets[vertex + 1]; ++i) {
+                    const Weight candidate_weight = weight + weights[i];
+                    if (candidate_weight < distances[targets[i]]) {
+                        distances[targets[i]] = candidate_weight;
+                        queue.push({ candidate_weight, targets[i] });
+                    }
+                }
+            }
+            return distances;
+        };
+
+        Table table;
+        table.vertex_count = vertex_count;
+        landmark_count = std::min(landmark_count, vertex_count);
+        if (landmark_count == 0) {
+            return table;
+        }
+
+        std::vector<std::vector<Weight>> from_landmarks;
+        std::vector<std::vector<Weight>> to_landmarks;
+        // Недостижимые вершины не учитываются, иначе опорными станут изолированные вершины
+        auto farthest = [](const std::vector<Weight>& distances) {
+            VertexId result = 0;
+            Weight max_distance{};
+            for (VertexId vertex = 0; vertex < distances.size(); ++vertex) {
+                if (distances[vertex] != Table::INFINITE_WEIGHT && distances[vertex] > max_distance) {
+                    result = vertex;
+                    max_distance = distances[vertex];
+                }
+            }
+            return result;
+        };
+        std::vector<Weight> nearest(vertex_count, Table::INFINITE_WEIGHT);
+        VertexId landmark = farthest(compute_distances(0, false));
+        while (table.landmarks.size() < landmark_count) {
+            table.landmarks.push_back(landmark);
+            from_landmarks.push_back(compute_distances(landmark, false));
+            to_landmarks.push_back(compute_distances(landmark, true));
+            for (VertexId vertex = 0; vertex < vertex_count; ++vertex) {
+                nearest[vertex] = std::min(nearest[vertex], from_landmarks.back()[vertex]);
+            }
+            landmark = farthest(nearest);
+        }
+
+        table.from_landmarks.resize(vertex_count * landmark_count);
+        table.to_landmarks.resize(vertex_count * landmark_count);
+        for (VertexId vertex = 0; vertex < vertex_count; ++vertex) {
+            for (size_t i = 0; i < landmark_count; ++i) {
+                table.from_landmarks[vertex * landmark_count + i] = from_landmarks[i][vertex];
+                table.to_landmarks[vertex * landmark_count + i] = to_landmarks[i][vertex];
+            }
+        }
+        return table;
+    }
+
+    template <typename Weight>
+    class AStarRouter : public RouteFinder<Weight> {
+    private:
+        using Graph = DirectedWeightedGraph<Weight>;
+
+    public:
+        using typename RouteFinder<Weight>::RouteInfo;
+        // Нижняя оценка веса пути от vertex до target, должна не превышать настоящий вес
+        using Heuristic = std::function<Weight(VertexId vertex, VertexId target)>;
+
+        AStarRouter(const Graph& graph, Heuristic heuristic, LandmarkTable<Weight>&& landmarks);
+
+        std::optional<RouteInfo> BuildRoute(VertexId from, VertexId to) const override;
+        const LandmarkTable<Weight>& GetLandmarks() const;
+
+    private:
+        using QueueItem = std::tuple<Weight, Weight, VertexId>;
+        using Queue = std::priority_queue<QueueItem, std::vector<QueueItem>, std::greater<QueueItem>>;
+
+        // Оценка по неравенству треугольника через опорные вершины
+        Weight GetLandmarkBound(VertexId vertex, VertexId target) const;
+
+        static constexpr Weight ZERO_WEIGHT{};
+        static constexpr Weight INFINITE_WEIGHT = LandmarkTable<Weight>::INFINITE_WEIGHT;
+        static constexpr EdgeId NO_EDGE = std::numeric_limits<EdgeId>::max();
+        const Graph& graph_;
+        Heuristic heuristic_;
+        LandmarkTable<Weight> landmarks_;
+    };
+
+    template <typename Weight>
+    AStarRouter<Weight>::AStarRouter(const Graph& graph, Heuristic heuristic, LandmarkTable<Weight>&& landmarks)
+        : graph_(graph)
+        , heuristic_(std::move(heuristic))
+        , landmarks_(std::move(landmarks))
+    {
+        const auto& weights = graph.GetAdjacency().weights;
+        if (std::any_of(weights.begin(), weights.end(), [](const Weight& weight) { return weight < ZERO_WEIGHT; })) {
+            throw std::domain_error("Edges' weights should be non-negative");
+        }
+        if (!landmarks_.landmarks.empty() && landmarks_.vertex_count != graph.GetVertexCount()) {
+            throw std::invalid_argument("Landmark table doesn't match the graph");
+        }
+    }
+
+    template <typename Weight>
+    const LandmarkTable<Weight>& AStarRouter<Weight>::GetLandmarks() const {
+        return landmarks_;
+    }
+
+    template <typename Weight>
+    Weight AStarRouter<Weight>::GetLandmarkBound(VertexId vertex, VertexId target) const {
+        const size_t landmark_count = landmarks_.landmarks.size();
+        if (landmark_count == 0) {
+            return ZERO_WEIGHT;
+        }
+        const Weight* from_vertex = &landmarks_.from_landmarks[vertex * landmark_count];
+        const Weight* from_target = &landmarks_.from_landmarks[target * landmark_count];
+        const Weight* to_vertex = &landmarks_.to_landmarks[vertex * landmark_count];
+        const Weight* to_target = &landmarks_.to_landmarks[target * landmark_count];
+        Weight bound = ZERO_WEIGHT;
+        for (size_t i = 0; i < landmark_count; ++i) {
+            if (from_vertex[i] != INFINITE_WEIGHT && from_target[i] != INFINITE_WEIGHT) {
+                bound = std::max(bound, from_target[i] - from_vertex[i]);
+            }
+            if (to_vertex[i] != INFINITE_WEIGHT && to_target[i] != INFINITE_WEIGHT) {
+                bound = std::max(bound, to_vertex[i] - to_target[i]);
+            }
+        }
+        return bound;
+    }
+
+    template <typename Weight>
+    std::optional<typename AStarRouter<Weight>::RouteInfo> AStarRouter<Weight>::BuildRoute(VertexId from, VertexId to) const {
+        const size_t vertex_count = graph_.GetVertexCount();
+        if (from >= vertex_count || to >= vertex_count) {
+            throw std::out_of_range("Vertex is out of range");
+        }
+        const auto& adjacency = graph_.GetAdjacency();
+        std::vector<Weight> weights(vertex_count, INFINITE_WEIGHT);
+        std::vector<Weight> potentials(vertex_count, INFINITE_WEIGHT);
+        std::vector<EdgeId> prev_edges(vertex_count, NO_EDGE);
+        auto get_potential = [this, &potentials, to](VertexId vertex) {
+            Weight& potential = potentials[vertex];
+            if (potential == INFINITE_WEIGHT) {
+                potential = std::max(heuristic_ ? heuristic_(vertex, to) : ZERO_WEIGHT, GetLandmarkBound(vertex, to));
+            }
+            return potential;
+        };
+
+        // Вершина может извлекаться из очереди повторно, поэтому путь оптимален и при несогласованной оценке
+        Queue queue;
+        weights[from] = ZERO_WEIGHT;
+        queue.push({ get_potential(from), ZERO_WEIGHT, from });
+        while (!queue.empty()) {
+            const auto [estimate, weight, vertex] = queue.top();
+            queue.pop();
+            if (weight > weights[vertex]) {
+                continue;
+            }
+            if (vertex == to) {
+                break;
+            }
+            for (uint32_t i = adjacency.offsets[vertex]; i < adjacency.offsets[vertex + 1]; ++i) {
+                const VertexId next = adjacency.targets[i];
+                const Weight candidate_weight = weight + adjacency.weights[i];
+                if (candidate_weight < weights[next]) {
+                    weights[next] = candidate_weight;
+                    prev_edges[next] = adjacency.edge_ids[i];
+                    queue.push({ candidate_weight + get_potential(next), candidate_weight, next });
+                }
+            }
+        }
+
+        if (weights[to] == INFINITE_WEIGHT) {
+            return std::nullopt;
+        }
+        std::vector<EdgeId> edges;
+        for (EdgeId edge_id = prev_edges[to]; edge_id != NO_EDGE; edge_id = prev_edges[graph_.GetEdge(edge_id).from]) {
+            edges.push_back(edge_id);
+        }
+        std::reverse(edges.begin(), edges.end());
+
+        return RouteInfo{ weights[to], std::move(edges) };
+    }
+
+}  // namespace graph
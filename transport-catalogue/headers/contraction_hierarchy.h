@@ -0,0 +1,455 @@
+#pragma once
+
+#include "graph.h"
+#include "router.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <optional>
+#include <queue>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace graph {
+
+    template <typename Weight>
+    class HubLabels;
+
+    template <typename Weight>
+    class ContractionHierarchy : public RouteFinder<Weight> {
+    private:
+        using Graph = DirectedWeightedGraph<Weight>;
+
+    public:
+        using typename RouteFinder<Weight>::RouteInfo;
+
+        // Ребро-сокращение заменяет пару ребер first + second, id больше GetEdgeCount() графа обозначают другие сокращения
+        struct Shortcut {
+            VertexId from;
+            VertexId to;
+            Weight weight;
+            EdgeId first;
+            EdgeId second;
+        };
+
+        struct Hierarchy {
+            std::vector<uint32_t> ranks;
+            std::vector<Shortcut> shortcuts;
+        };
+
+        explicit ContractionHierarchy(const Graph& graph);
+        ContractionHierarchy(const Graph& graph, Hierarchy&& hierarchy);
+
+        std::optional<RouteInfo> BuildRoute(VertexId from, VertexId to) const override;
+        const Hierarchy& GetHierarchy() const;
+
+    private:
+        friend class HubLabels<Weight>;
+
+        struct Arc {
+            VertexId target;
+            Weight weight;
+            EdgeId id;
+        };
+
+        struct Label {
+            Weight weight;
+            EdgeId arc;
+        };
+
+        using Labels = std::vector<Label>;
+        using QueueItem = std::pair<Weight, VertexId>;
+        using Queue = std::priority_queue<QueueItem, std::vector<QueueItem>, std::greater<QueueItem>>;
+
+        class Contractor {
+        public:
+            explicit Contractor(const Graph& graph);
+            Hierarchy Contract();
+
+        private:
+            // Возвращает число сокращений, необходимых при стягивании вершины, и при add == true добавляет их
+            size_t ContractVertex(VertexId vertex, bool add);
+            int GetPriority(VertexId vertex);
+            // Ищет пути из from в обход excluded не длиннее limit, результат остается в witness_weights_
+            void FindWitnesses(VertexId from, VertexId excluded, Weight limit);
+            void AddArc(VertexId from, VertexId to, Weight weight, EdgeId id);
+            void RemoveVertex(VertexId vertex);
+
+            const Graph& graph_;
+            std::vector<std::vector<Arc>> out_;
+            std::vector<std::vector<Arc>> in_;
+            std::vector<int> contracted_neighbors_;
+            std::vector<int> levels_;
+            std::vector<Weight> witness_weights_;
+            std::vector<VertexId> witness_touched_;
+            Hierarchy hierarchy_;
+        };
+
+        void BuildSearchGraph();
+        // stall_offsets и stall_arcs - ребра противоположного направления, по ним вершина отсекается (stall-on-demand),
+        // если до нее есть более короткий путь через вершину с большим рангом
+        void Search(const std::vector<size_t>& offsets, const std::vector<Arc>& arcs, const std::vector<size_t>& stall_offsets,
+            const std::vector<Arc>& stall_arcs, Labels& labels, Queue& queue, const Labels& opposite_labels,
+            std::optional<std::pair<Weight, VertexId>>& best) const;
+        void UnpackArc(EdgeId arc, std::vector<EdgeId>& edges) const;
+        // Начало и конец ребра поискового графа - исходного ребра или сокращения
+        std::pair<VertexId, VertexId> GetArcEnds(EdgeId arc) const;
+
+        static constexpr Weight ZERO_WEIGHT{};
+        static constexpr Weight UNREACHED = std::numeric_limits<Weight>::max();
+        static constexpr size_t WITNESS_SETTLE_LIMIT = 500;
+        const Graph& graph_;
+        Hierarchy hierarchy_;
+        std::vector<size_t> forward_offsets_;
+        std::vector<Arc> forward_arcs_;
+        std::vector<size_t> backward_offsets_;
+        std::vector<Arc> backward_arcs_;
+    };
+
+    template <typename Weight>
+    ContractionHierarchy<Weight>::Contractor::Contractor(const Graph& graph)
+        : graph_(graph)
+        , out_(graph.GetVertexCount())
+        , in_(graph.GetVertexCount())
+        , contracted_neighbors_(graph.GetVertexCount(), 0)
+        , levels_(graph.GetVertexCount(), 0)
+        , witness_weights_(graph.GetVertexCount(), std::numeric_limits<Weight>::max())
+    {
+        const auto& adjacency = graph.GetAdjacency();
+        for (VertexId vertex = 0; vertex < graph.GetVertexCount(); ++vertex) {
+            for (uint32_t i = adjacency.offsets[vertex]; i < adjacency.offsets[vertex + 1]; ++i) {
+                if (adjacency.weights[i] < ZERO_WEIGHT) {
+                    throw std::domain_error("Edges' weights should be non-negative");
+                }
+                if (adjacency.targets[i] != vertex) {
+                    AddArc(vertex, adjacency.targets[i], adjacency.weights[i], adjacency.edge_ids[i]);
+                }
+            }
+        }
+    }
+
+    template <typename Weight>
+    void ContractionHierarchy<Weight>::Contractor::AddArc(VertexId from, VertexId to, Weight weight, EdgeId id) {
+        auto same_target = [to](const Arc& arc) { return arc.target == to; };
+        auto out_it = std::find_if(out_[from].begin(), out_[from].end(), same_target);
+        if (out_it != out_[from].end()) {
+            if (out_it->weight <= weight) {
+                return;
+            }
+            *out_it = Arc{ to, weight, id };
+            auto in_it = std::find_if(in_[to].begin(), in_[to].end(), [from](const Arc& arc) { return arc.target == from; });
+            *in_it = Arc{ from, weight, id };
+            return;
+        }
+        out_[from].push_back(Arc{ to, weight, id });
+        in_[to].push_back(Arc{ from, weight, id });
+    }
+
+    template <typename Weight>
+    void ContractionHierarchy<Weight>::Contractor::FindWitnesses(VertexId from, VertexId excluded, Weight limit) {
+        for (VertexId vertex : witness_touched_) {
+            witness_weights_[vertex] = std::numeric_limits<Weight>::max();
+        }
+        witness_touched_.clear();
+
+        Queue queue;
+        witness_weights_[from] = ZERO_WEIGHT;
+        witness_touched_.push_back(from);
+        queue.push({ ZERO_WEIGHT, from });
+        for (size_t settled = 0; !queue.empty() && settled < WITNESS_SETTLE_LIMIT; ++settled) {
+            const auto [weight, vertex] = queue.top();
+            queue.pop();
+            if (weight > witness_weights_[vertex]) {
+                continue;
+            }
+            for (const Arc& arc : out_[vertex]) {
+                if (arc.target == excluded) {
+                    continue;
+                }
+                const Weight candidate_weight = weight + arc.weight;
+                if (candidate_weight <= limit && candidate_weight < witness_weights_[arc.target]) {
+                    if (witness_weights_[arc.target] == std::numeric_limits<Weight>::max()) {
+                        witness_touched_.push_back(arc.target);
+                    }
+                    witness_weights_[arc.target] = candidate_weight;
+                    queue.push({ candidate_weight, arc.target });
+                }
+            }
+        }
+    }
+
+    template <typename Weight>
+    size_t ContractionHierarchy<Weight>::Contractor::ContractVertex(VertexId vertex, bool add) {
+        size_t shortcut_count = 0;
+        const std::vector<Arc> incoming = in_[vertex];
+        const std::vector<Arc> outgoing = out_[vertex];
+        if (outgoing.empty()) {
+            return 0;
+        }
+        const Weight max_out_weight = std::max_element(outgoing.begin(), outgoing.end(), [](const Arc& lhs, const Arc& rhs) {
+            return lhs.weight < rhs.weight;
+        })->weight;
+
+        for (const Arc& in_arc : incoming) {
+            FindWitnesses(in_arc.target, vertex, in_arc.weight + max_out_weight);
+            for (const Arc& out_arc : outgoing) {
+                if (out_arc.target == in_arc.target) {
+                    continue;
+                }
+                const Weight weight = in_arc.weight + out_arc.weight;
+                if (witness_weights_[out_arc.target] <= weight) {
+                    continue;
+                }
+                ++shortcut_count;
+                if (add) {
+                    const EdgeId id = graph_.GetEdgeCount() + hierarchy_.shortcuts.size();
+                    hierarchy_.shortcuts.push_back(Shortcut{ in_arc.target, out_arc.target, weight, in_arc.id, out_arc.id });
+                    AddArc(in_arc.target, out_arc.target, weight, id);
+                }
+            }
+        }
+        return shortcut_count;
+    }
+
+    template <typename Weight>
+    int ContractionHierarchy<Weight>::Contractor::GetPriority(VertexId vertex) {
+        const int shortcut_count = static_cast<int>(ContractVertex(vertex, false));
+        const int removed_count = static_cast<int>(in_[vertex].size() + out_[vertex].size());
+        return 2 * (shortcut_count - removed_count) + contracted_neighbors_[vertex] + levels_[vertex];
+    }
+
+    template <typename Weight>
+    void ContractionHierarchy<Weight>::Contractor::RemoveVertex(VertexId vertex) {
+        auto points_to_vertex = [vertex](const Arc& arc) { return arc.target == vertex; };
+        for (const Arc& arc : in_[vertex]) {
+            auto& arcs = out_[arc.target];
+            arcs.erase(std::remove_if(arcs.begin(), arcs.end(), points_to_vertex), arcs.end());
+            ++contracted_neighbors_[arc.target];
+            levels_[arc.target] = std::max(levels_[arc.target], levels_[vertex] + 1);
+        }
+        for (const Arc& arc : out_[vertex]) {
+            auto& arcs = in_[arc.target];
+            arcs.erase(std::remove_if(arcs.begin(), arcs.end(), points_to_vertex), arcs.end());
+            ++contracted_neighbors_[arc.target];
+            levels_[arc.target] = std::max(levels_[arc.target], levels_[vertex] + 1);
+        }
+        std::vector<Arc>().swap(in_[vertex]);
+        std::vector<Arc>().swap(out_[vertex]);
+    }
+
+    template <typename Weight>
+    typename ContractionHierarchy<Weight>::Hierarchy ContractionHierarchy<Weight>::Contractor::Contract() {
+        const size_t vertex_count = graph_.GetVertexCount();
+        hierarchy_.ranks.assign(vertex_count, 0);
+
+        using PriorityItem = std::pair<int, VertexId>;
+        std::priority_queue<PriorityItem, std::vector<PriorityItem>, std::greater<PriorityItem>> queue;
+        for (VertexId vertex = 0; vertex < vertex_count; ++vertex) {
+            queue.push({ GetPriority(vertex), vertex });
+        }
+
+        // Приоритеты пересчитываются лениво: вершина стягивается, если после пересчета она по-прежнему наименьшая
+        uint32_t rank = 0;
+        while (!queue.empty()) {
+            const VertexId vertex = queue.top().second;
+            queue.pop();
+            const int priority = GetPriority(vertex);
+            if (!queue.empty() && priority > queue.top().first) {
+                queue.push({ priority, vertex });
+                continue;
+            }
+            ContractVertex(vertex, true);
+            RemoveVertex(vertex);
+            hierarchy_.ranks[vertex] = rank++;
+        }
+        return std::move(hierarchy_);
+    }
+
+    template <typename Weight>
+    ContractionHierarchy<Weight>::ContractionHierarchy(const Graph& graph)
+        : graph_(graph)
+        , hierarchy_(Contractor(graph).Contract())
+    {
+        BuildSearchGraph();
+    }
+
+    template <typename Weight>
+    ContractionHierarchy<Weight>::ContractionHierarchy(const Graph& graph, Hierarchy&& hierarchy)
+        : graph_(graph)
+        , hierarchy_(std::move(hierarchy))
+    {
+        if (hierarchy_.ranks.size() != graph.GetVertexCount()) {
+            throw std::invalid_argument("Hierarchy doesn't match the graph");
+        }
+        BuildSearchGraph();
+    }
+
+    template <typename Weight>
+    const typename ContractionHierarchy<Weight>::Hierarchy& ContractionHierarchy<Weight>::GetHierarchy() const {
+        return hierarchy_;
+    }
+
+    template <typename Weight>
+    void ContractionHierarchy<Weight>::BuildSearchGraph() {
+        const size_t vertex_count = graph_.GetVertexCount();
+        const size_t edge_count = graph_.GetEdgeCount();
+        const auto& ranks = hierarchy_.ranks;
+
+        // Прямой поиск идет только по ребрам вверх по рангу, обратный - по входящим ребрам, пришедшим сверху
+        auto for_each_arc = [&](auto callback) {
+            const auto& adjacency = graph_.GetAdjacency();
+            for (VertexId vertex = 0; vertex < vertex_count; ++vertex) {
+                for (uint32_t i = adjacency.offsets[vertex]; i < adjacency.offsets[vertex + 1]; ++i) {
+                    callback(vertex, adjacency.targets[i], adjacency.weights[i], adjacency.edge_ids[i]);
+                }
+            }
+            for (size_t i = 0; i < hierarchy_.shortcuts.size(); ++i) {
+                const Shortcut& shortcut = hierarchy_.shortcuts[i];
+                callback(shortcut.from, shortcut.to, shortcut.weight, edge_count + i);
+            }
+        };
+
+        forward_offsets_.assign(vertex_count + 1, 0);
+        backward_offsets_.assign(vertex_count + 1, 0);
+        for_each_arc([&](VertexId from, VertexId to, Weight, EdgeId) {
+            if (ranks[from] < ranks[to]) {
+                ++forward_offsets_[from + 1];
+            }else if (ranks[from] > ranks[to]) {
+                ++backward_offsets_[to + 1];
+            }
+        });
+        for (size_t vertex = 0; vertex < vertex_count; ++vertex) {
+            forward_offsets_[vertex + 1] += forward_offsets_[vertex];
+            backward_offsets_[vertex + 1] += backward_offsets_[vertex];
+        }
+
+        forward_arcs_.resize(forward_offsets_.back());
+        backward_arcs_.resize(backward_offsets_.back());
+        std::vector<size_t> forward_fill(forward_offsets_.begin(), forward_offsets_.end() - 1);
+        std::vector<size_t> backward_fill(backward_offsets_.begin(), backward_offsets_.end() - 1);
+        for_each_arc([&](VertexId from, VertexId to, Weight weight, EdgeId id) {
+            if (ranks[from] < ranks[to]) {
+                forward_arcs_[forward_fill[from]++] = Arc{ to, weight, id };
+            }else if (ranks[from] > ranks[to]) {
+                backward_arcs_[backward_fill[to]++] = Arc{ from, weight, id };
+            }
+        });
+    }
+
+    template <typename Weight>
+    void ContractionHierarchy<Weight>::Search(const std::vector<size_t>& offsets, const std::vector<Arc>& arcs,
+        const std::vector<size_t>& stall_offsets, const std::vector<Arc>& stall_arcs, Labels& labels, Queue& queue,
+        const Labels& opposite_labels, std::optional<std::pair<Weight, VertexId>>& best) const {
+        const auto [weight, vertex] = queue.top();
+        queue.pop();
+        if (weight > labels[vertex].weight) {
+            return;
+        }
+        if (opposite_labels[vertex].weight != UNREACHED) {
+            const Weight route_weight = weight + opposite_labels[vertex].weight;
+            if (!best || route_weight < best->first) {
+                best = { route_weight, vertex };
+            }
+        }
+        for (size_t i = stall_offsets[vertex]; i < stall_offsets[vertex + 1]; ++i) {
+            const Arc& arc = stall_arcs[i];
+            if (labels[arc.target].weight != UNREACHED && labels[arc.target].weight + arc.weight < weight) {
+                return;
+            }
+        }
+        for (size_t i = offsets[vertex]; i < offsets[vertex + 1]; ++i) {
+            const Arc& arc = arcs[i];
+            const Weight candidate_weight = weight + arc.weight;
+            Label& label = labels[arc.target];
+            if (label.weight == UNREACHED || candidate_weight < label.weight) {
+                label = Label{ candidate_weight, arc.id };
+                queue.push({ candidate_weight, arc.target });
+            }
+        }
+    }
+
+    template <typename Weight>
+    void ContractionHierarchy<Weight>::UnpackArc(EdgeId arc, std::vector<EdgeId>& edges) const {
+        std::vector<EdgeId> stack = { arc };
+        while (!stack.empty()) {
+            const EdgeId id = stack.back();
+            stack.pop_back();
+            if (id < graph_.GetEdgeCount()) {
+                edges.push_back(id);
+                continue;
+            }
+            const Shortcut& shortcut = hierarchy_.shortcuts[id - graph_.GetEdgeCount()];
+            stack.push_back(shortcut.second);
+            stack.push_back(shortcut.first);
+        }
+    }
+
+    template <typename Weight>
+    std::pair<VertexId, VertexId> ContractionHierarchy<Weight>::GetArcEnds(EdgeId arc) const {
+        if (arc < graph_.GetEdgeCount()) {
+            const auto& edge = graph_.GetEdge(arc);
+            return { edge.from, edge.to };
+        }
+        const Shortcut& shortcut = hierarchy_.shortcuts[arc - graph_.GetEdgeCount()];
+        return { shortcut.from, shortcut.to };
+    }
+
+    template <typename Weight>
+    std::optional<typename ContractionHierarchy<Weight>::RouteInfo> ContractionHierarchy<Weight>::BuildRoute(VertexId from,
+        VertexId to) const {
+        const size_t vertex_count = graph_.GetVertexCount();
+        if (from >= vertex_count || to >= vertex_count) {
+            throw std::out_of_range("Vertex is out of range");
+        }
+
+        constexpr EdgeId NO_ARC = std::numeric_limits<EdgeId>::max();
+        Labels forward_labels(vertex_count, Label{ UNREACHED, NO_ARC });
+        Labels backward_labels(vertex_count, Label{ UNREACHED, NO_ARC });
+        forward_labels[from].weight = ZERO_WEIGHT;
+        backward_labels[to].weight = ZERO_WEIGHT;
+        Queue forward_queue;
+        Queue backward_queue;
+        forward_queue.push({ ZERO_WEIGHT, from });
+        backward_queue.push({ ZERO_WEIGHT, to });
+        std::optional<std::pair<Weight, VertexId>> best;
+
+        // Каждое направление останавливается, когда его минимум в очереди не меньше лучшего найденного пути
+        auto is_active = [&best](const Queue& queue) {
+            return !queue.empty() && (!best || queue.top().first < best->first);
+        };
+        while (is_active(forward_queue) || is_active(backward_queue)) {
+            if (is_active(forward_queue)) {
+                Search(forward_offsets_, forward_arcs_, backward_offsets_, backward_arcs_, forward_labels, forward_queue, backward_labels, best);
+            }
+            if (is_active(backward_queue)) {
+                Search(backward_offsets_, backward_arcs_, forward_offsets_, forward_arcs_, backward_labels, backward_queue, forward_labels, best);
+            }
+        }
+        if (!best) {
+            return std::nullopt;
+        }
+
+        std::vector<EdgeId> arcs;
+        for (VertexId vertex = best->second; forward_labels[vertex].arc != NO_ARC; ) {
+            const EdgeId arc = forward_labels[vertex].arc;
+            arcs.push_back(arc);
+            vertex = GetArcEnds(arc).first;
+        }
+        std::reverse(arcs.begin(), arcs.end());
+        for (VertexId vertex = best->second; backward_labels[vertex].arc != NO_ARC; ) {
+            const EdgeId arc = backward_labels[vertex].arc;
+            arcs.push_back(arc);
+            vertex = GetArcEnds(arc).second;
+        }
+
+        std::vector<EdgeId> edges;
+        for (const EdgeId arc : arcs) {
+            UnpackArc(arc, edges);
+        }
+        return RouteInfo{ best->first, std::move(edges) };
+    }
+
+}  // namespace graph
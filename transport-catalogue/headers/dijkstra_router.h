@@ -0,0 +1,117 @@
+#pragma once
+
+#include "graph.h"
+#include "router.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <optional>
+#include <queue>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace graph {
+
+    template <typename Weight>
+    using MinQueue = std::priority_queue<std::pair<Weight, VertexId>, std::vector<std::pair<Weight, VertexId>>,
+        std::greater<std::pair<Weight, VertexId>>>;
+
+    // Queue - очередь с интерфейсом std::priority_queue, извлекающая минимальный вес, например RadixHeap.
+    // Поиск идет в типе веса очереди: если он отличается от веса графа, веса ребер переводятся в него один раз при создании
+    template <typename Weight, typename Queue = MinQueue<Weight>>
+    class DijkstraRouter : public RouteFinder<Weight> {
+    private:
+        using Graph = DirectedWeightedGraph<Weight>;
+
+    public:
+        using typename RouteFinder<Weight>::RouteInfo;
+
+        explicit DijkstraRouter(const Graph& graph);
+
+        std::optional<RouteInfo> BuildRoute(VertexId from, VertexId to) const override;
+
+    private:
+        using SearchWeight = typename Queue::value_type::first_type;
+
+        static constexpr Weight ZERO_WEIGHT{};
+        static constexpr EdgeId NO_EDGE = std::numeric_limits<EdgeId>::max();
+        const Graph& graph_;
+        std::vector<SearchWeight> search_weights_;
+    };
+
+    template <typename Weight, typename Queue>
+    DijkstraRouter<Weight, Queue>::DijkstraRouter(const Graph& graph)
+        : graph_(graph)
+    {
+        const auto& weights = graph.GetAdjacency().weights;
+        if (std::any_of(weights.begin(), weights.end(), [](const Weight& weight) { return weight < ZERO_WEIGHT; })) {
+            throw std::domain_error("Edges' weights should be non-negative");
+        }
+        if constexpr (!std::is_same_v<SearchWeight, Weight>) {
+            search_weights_.reserve(weights.size());
+            for (const Weight& weight : weights) {
+                search_weights_.push_back(static_cast<SearchWeight>(weight));
+            }
+        }
+    }
+
+    template <typename Weight, typename Queue>
+    std::optional<typename DijkstraRouter<Weight, Queue>::RouteInfo> DijkstraRouter<Weight, Queue>::BuildRoute(VertexId from,
+        VertexId to) const {
+        const size_t vertex_count = graph_.GetVertexCount();
+        const auto& adjacency = graph_.GetAdjacency();
+        std::vector<std::optional<SearchWeight>> weights(vertex_count);
+        std::vector<EdgeId> prev_edges(vertex_count, NO_EDGE);
+        std::vector<bool> settled(vertex_count, false);
+        Queue queue;
+
+        if (from >= vertex_count || to >= vertex_count) {
+            throw std::out_of_range("Vertex is out of range");
+        }
+        const SearchWeight* edge_weights = nullptr;
+        if constexpr (std::is_same_v<SearchWeight, Weight>) {
+            edge_weights = adjacency.weights.data();
+        }else {
+            edge_weights = search_weights_.data();
+        }
+        weights[from] = SearchWeight{};
+        queue.push({ SearchWeight{}, from });
+        while (!queue.empty()) {
+            const auto [weight, vertex] = queue.top();
+            queue.pop();
+            if (settled[vertex]) {
+                continue;
+            }
+            settled[vertex] = true;
+            if (vertex == to) {
+                break;
+            }
+            for (uint32_t i = adjacency.offsets[vertex]; i < adjacency.offsets[vertex + 1]; ++i) {
+                const VertexId next = adjacency.targets[i];
+                const SearchWeight candidate_weight = weight + edge_weights[i];
+                auto& route_weight = weights[next];
+                if (!route_weight || candidate_weight < *route_weight) {
+                    route_weight = candidate_weight;
+                    prev_edges[next] = adjacency.edge_ids[i];
+                    queue.push({ candidate_weight, next });
+                }
+            }
+        }
+
+        if (!settled[to]) {
+            return std::nullopt;
+        }
+        std::vector<EdgeId> edges;
+        for (EdgeId edge_id = prev_edges[to]; edge_id != NO_EDGE; edge_id = prev_edges[graph_.GetEdge(edge_id).from]) {
+            edges.push_back(edge_id);
+        }
+        std::reverse(edges.begin(), edges.end());
+
+        return RouteInfo{ static_cast<Weight>(*weights[to]), std::move(edges) };
+    }
+
+}  // namespace graph
@@ -0,0 +1,123 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <limits>
+#include <vector>
+
+namespace transport {
+namespace catalog {
+	//Расстояния между остановками в открытой адресации с линейным пробированием, ключ - упакованная пара id.
+	//Вместе с заданным расстоянием хранится и обратное направление, пока оно не задано явно,
+	//поэтому запрос в любую сторону - одна проба без второго поиска
+	class DistanceTable {
+	public:
+		void Set(uint32_t from, uint32_t to, int distance) {
+			Slot& forward = FindOrInsert(PackKey(from, to));
+			forward.distance = distance;
+			forward.given = true;
+			Slot& backward = FindOrInsert(PackKey(to, from));
+			if (!backward.given) {
+				backward.distance = distance;
+			}
+		}
+
+		//Заданное расстояние, иначе заданное в обратную сторону, иначе 0
+		int Get(uint32_t from, uint32_t to) const {
+			if (slots_.empty()) {
+				return 0;
+			}
+			const uint64_t key = PackKey(from, to);
+			for (size_t index = GetHome(key); ; index = (index + 1) & mask_) {
+				const Slot& slot = slots_[index];
+				if (slot.key == key) {
+					return slot.distance;
+				}
+				if (slot.key == EMPTY_KEY) {
+					return 0;
+				}
+			}
+		}
+
+		//Обходит только явно заданные расстояния: action(from, to, distance)
+		template <typename Action>
+		void ForEachGiven(Action action) const {
+			for (const Slot& slot : slots_) {
+				if (slot.key != EMPTY_KEY && slot.given) {
+					action(static_cast<uint32_t>(slot.key >> 32), static_cast<uint32_t>(slot.key), slot.distance);
+				}
+			}
+		}
+
+		void Reserve(size_t count) {
+			//Каждое расстояние занимает до двух ячеек, заполнение держится не выше половины
+			size_t capacity = MIN_CAPACITY;
+			while (capacity < count * 4) {
+				capacity *= 2;
+			}
+			if (capacity > slots_.size()) {
+				Rehash(capacity);
+			}
+		}
+
+	private:
+		static constexpr uint64_t EMPTY_KEY = std::numeric_limits<uint64_t>::max();
+		static constexpr size_t MIN_CAPACITY = 16;
+
+		struct Slot {
+			uint64_t key = EMPTY_KEY;
+			int distance = 0;
+			bool given = false;
+		};
+
+		static uint64_t PackKey(uint32_t from, uint32_t to) {
+			return (static_cast<uint64_t>(from) << 32) | to;
+		}
+
+		//Мультипликативное хеширование Фибоначчи: старшие биты произведения равномерны и для соседних id
+		size_t GetHome(uint64_t key) const {
+			return static_cast<size_t>((key * 0x9E3779B97F4A7C15ull) >> shift_);
+		}
+
+		Slot& FindOrInsert(uint64_t key) {
+			if ((used_ + 1) * 2 > slots_.size()) {
+				Rehash(slots_.empty() ? MIN_CAPACITY : slots_.size() * 2);
+			}
+			size_t index = GetHome(key);
+			while (slots_[index].key != key) {
+				if (slots_[index].key == EMPTY_KEY) {
+					slots_[index].key = key;
+					++used_;
+					break;
+				}
+				index = (index + 1) & mask_;
+			}
+			return slots_[index];
+		}
+
+		void Rehash(size_t capacity) {
+			std::vector<Slot> old = std::move(slots_);
+			slots_.assign(capacity, Slot{});
+			mask_ = capacity - 1;
+			shift_ = 64;
+			for (size_t size = capacity; size > 1; size /= 2) {
+				--shift_;
+			}
+			for (const Slot& slot : old) {
+				if (slot.key == EMPTY_KEY) {
+					continue;
+				}
+				size_t index = GetHome(slot.key);
+				while (slots_[index].key != EMPTY_KEY) {
+					index = (index + 1) & mask_;
+				}
+				slots_[index] = slot;
+			}
+		}
+
+		std::vector<Slot> slots_;
+		size_t used_ = 0;
+		size_t mask_ = 0;
+		unsigned shift_ = 64;
+	};
+}
+}
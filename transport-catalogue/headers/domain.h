@@ -10,17 +10,18 @@
 #include <optional>
 #include <vector>
 #include <cmath>
+#include <cstdint>
 
 namespace transport {
 namespace domain {
     using SettingType = std::variant<double, std::pair<double, double>, svg::Color, std::vector<svg::Color>>;
 
     struct Stop {        
-        std::string name = "";
+        std::string_view name;
         geo::Coordinates coord = { 0.0, 0.0 };
-        size_t id = 0;
+        uint32_t id = 0;
         Stop() = default;
-        Stop(std::string_view name_, geo::Coordinates coord_, size_t id_) :name(name_), coord(coord_), id(id_) {};
+        Stop(std::string_view name_, geo::Coordinates coord_, uint32_t id_) :name(name_), coord(coord_), id(id_) {};
         bool operator==(const Stop& other) const {
             return name == other.name;
         }
@@ -29,19 +30,44 @@ namespace domain {
         }            
     };
 
-    struct StopCompare{
-        bool operator()(const Stop* lhs, const Stop* rhs) const {
-            return lhs->name < rhs->name;
-        }
-    };
-
     struct Bus {
-        std::string name = "";
-        std::deque<const Stop*> stops = {};
+        std::string_view name;
+        uint32_t firstStop = 0;
+        uint32_t stopCount = 0;
         bool loope = false;
-        size_t id = 0;
+        uint32_t id = 0;
         Bus() = default;
-        Bus(std::string_view name_, std::deque<const Stop*> stops_, bool loope_, size_t id_) :name(name_), stops(std::move(stops_)), loope(loope_), id(id_) {};
+        Bus(std::string_view name_, uint32_t firstStop_, uint32_t stopCount_, bool loope_, uint32_t id_) :name(name_), firstStop(firstStop_), stopCount(stopCount_), loope(loope_), id(id_) {};
+    };
+
+    class StopIds {
+    public:
+        StopIds() = default;
+        StopIds(const uint32_t* first, size_t count) :first_(first), count_(count) {};
+        const uint32_t* begin() const {
+            return first_;
+        }
+        const uint32_t* end() const {
+            return first_ + count_;
+        }
+        size_t size() const {
+            return count_;
+        }
+        bool empty() const {
+            return count_ == 0;
+        }
+        uint32_t operator[](size_t index) const {
+            return first_[index];
+        }
+        uint32_t front() const {
+            return first_[0];
+        }
+        uint32_t back() const {
+            return first_[count_ - 1];
+        }
+    private:
+        const uint32_t* first_ = nullptr;
+        size_t count_ = 0;
     };
 
     struct Route {
@@ -54,12 +80,6 @@ namespace domain {
         Route(std::string_view name_, size_t stops_, size_t uStops_, double length_, double curvature_) :name(name_), stops(stops_), uStops(uStops_), length(length_), curvature(curvature_) {};
     };
 
-	struct StopLengthHasher {
-		size_t operator()(std::pair<const Stop*, const Stop*> key) const {
-			return static_cast<size_t>(key.first->name.size() * key.first->coord.lat * key.first->coord.lng * key.second->name.size() * key.second->coord.lat * key.second->coord.lng);
-		}
-	};    
-
     struct DistanceBwStops {
         std::string_view fromStop_;
         std::string_view toStop_;
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <limits>
+
+namespace graph {
+
+    // Вес в фиксированной точке: целое число сотых долей секунды, вес графа задан в минутах.
+    // Занимает вдвое меньше double, ошибка каждого веса не больше половины тика.
+    // Бесконечность - половина диапазона uint32_t: сумма двух весов не переполняется и без насыщения,
+    // а сумма с бесконечностью не меньше бесконечности и потому никогда не оказывается лучше
+    struct FixedWeight {
+        static constexpr double TICKS_PER_MINUTE = 6000;
+        static constexpr uint32_t INFINITE_TICKS = std::numeric_limits<int32_t>::max();
+
+        uint32_t ticks = 0;
+
+        constexpr FixedWeight() = default;
+        explicit FixedWeight(double minutes) {
+            const double rounded = std::round(minutes * TICKS_PER_MINUTE);
+            ticks = rounded < static_cast<double>(INFINITE_TICKS) ? static_cast<uint32_t>(rounded) : INFINITE_TICKS;
+        }
+
+        static constexpr FixedWeight FromTicks(uint32_t ticks) {
+            FixedWeight weight;
+            weight.ticks = ticks;
+            return weight;
+        }
+
+        explicit operator double() const {
+            return ticks >= INFINITE_TICKS ? std::numeric_limits<double>::infinity() : ticks / TICKS_PER_MINUTE;
+        }
+
+        friend FixedWeight operator+(FixedWeight lhs, FixedWeight rhs) {
+            return FromTicks(lhs.ticks + rhs.ticks);
+        }
+        friend bool operator==(FixedWeight lhs, FixedWeight rhs) {
+            return lhs.ticks == rhs.ticks;
+        }
+        friend bool operator!=(FixedWeight lhs, FixedWeight rhs) {
+            return lhs.ticks != rhs.ticks;
+        }
+        friend bool operator<(FixedWeight lhs, FixedWeight rhs) {
+            return lhs.ticks < rhs.ticks;
+        }
+        friend bool operator>(FixedWeight lhs, FixedWeight rhs) {
+            return lhs.ticks > rhs.ticks;
+        }
+    };
+
+}  // namespace graph
+
+namespace std {
+
+    template <>
+    struct numeric_limits<graph::FixedWeight> : numeric_limits<uint32_t> {
+        static constexpr bool has_infinity = true;
+        static constexpr graph::FixedWeight infinity() noexcept {
+            return graph::FixedWeight::FromTicks(graph::FixedWeight::INFINITE_TICKS);
+        }
+        static constexpr graph::FixedWeight max() noexcept {
+            return graph::FixedWeight::FromTicks(graph::FixedWeight::INFINITE_TICKS - 1);
+        }
+        static constexpr graph::FixedWeight lowest() noexcept {
+            return graph::FixedWeight::FromTicks(0);
+        }
+        static constexpr graph::FixedWeight min() noexcept {
+            return graph::FixedWeight::FromTicks(0);
+        }
+    };
+
+}  // namespace std
@@ -2,65 +2,179 @@
 
 #include "ranges.h"
 
+#include <cstdint>
 #include <cstdlib>
-#include <string_view>
+#include <limits>
+#include <stdexcept>
 #include <vector>
 
 namespace graph {
 
     using VertexId = size_t;
-    using Name = std::string_view;
     using EdgeId = size_t;
 
+    // RIDE и ALIGHT - перегон между соседними остановками и высадка в линейной модели графа
+    enum class EdgeType : uint8_t {
+        WAIT,
+        BUS,
+        RIDE,
+        ALIGHT
+    };
+
+    // itemId - id остановки для ожидания или id маршрута для поездки, имена берутся из справочника при построении Trip
     template <typename Weight>
     struct Edge {
         VertexId from;
         VertexId to;
-        Name fromName;
-        Name toName;
-        Name name;
-        std::string type;
         Weight weight;
+        EdgeType type = EdgeType::BUS;
+        uint32_t itemId = 0;
         int stopCount = 0;
     };
 
     template <typename Weight>
     class DirectedWeightedGraph {
     private:
-        using IncidenceList = std::vector<EdgeId>;
-        using IncidentEdgesRange = ranges::Range<typename IncidenceList::const_iterator>;
+        using IncidenceList = std::vector<uint32_t>;
+        using IncidentEdgesRange = ranges::Range<const uint32_t*>;
 
     public:
+        // Исходящие ребра вершины v - элементы targets, weights и edge_ids с offsets[v] до offsets[v + 1]
+        struct Adjacency {
+            std::vector<uint32_t> offsets;
+            std::vector<uint32_t> targets;
+            std::vector<Weight> weights;
+            std::vector<uint32_t> edge_ids;
+        };
+
         DirectedWeightedGraph() = default;
         explicit DirectedWeightedGraph(size_t vertex_count);
         EdgeId AddEdge(const Edge<Weight>& edge);
+        // Меняют уже добавленное ребро, граф при этом не должен быть заморожен
+        void SetEdgeWeight(EdgeId edge_id, Weight weight);
+        // Вес и описание ребра (маршрут, число остановок) меняются, вершины должны остаться прежними
+        void SetEdge(EdgeId edge_id, const Edge<Weight>& edge);
+        // Ребро остается в списке с бесконечным весом, чтобы id остальных ребер не сдвигались, в CSR оно не попадает
+        void RemoveEdge(EdgeId edge_id);
+        bool IsEdgeRemoved(EdgeId edge_id) const;
+        // Переводит списки смежности в CSR, после этого граф не меняется
+        void Freeze();
+        // Возвращает списки смежности из CSR, чтобы граф можно было изменить и заморозить заново
+        void Unfreeze();
 
         size_t GetVertexCount() const;
         size_t GetEdgeCount() const;
         const Edge<Weight>& GetEdge(EdgeId edge_id) const;
         IncidentEdgesRange GetIncidentEdges(VertexId vertex) const;
+        bool IsFrozen() const;
+        const Adjacency& GetAdjacency() const;
 
     private:
+        size_t vertex_count_ = 0;
+        bool frozen_ = false;
         std::vector<Edge<Weight>> edges_;
         std::vector<IncidenceList> incidence_lists_;
+        Adjacency adjacency_;
     };
 
     template <typename Weight>
     DirectedWeightedGraph<Weight>::DirectedWeightedGraph(size_t vertex_count)
-        : incidence_lists_(vertex_count) {
+        : vertex_count_(vertex_count)
+        , incidence_lists_(vertex_count) {
     }
 
     template <typename Weight>
     EdgeId DirectedWeightedGraph<Weight>::AddEdge(const Edge<Weight>& edge) {
+        if (frozen_) {
+            throw std::logic_error("Graph is frozen");
+        }
+        if (edges_.size() >= std::numeric_limits<uint32_t>::max()) {
+            throw std::length_error("Too many edges");
+        }
         edges_.push_back(edge);
         const EdgeId id = edges_.size() - 1;
-        incidence_lists_.at(edge.from).push_back(id);
+        incidence_lists_.at(edge.from).push_back(static_cast<uint32_t>(id));
         return id;
     }
 
+    template <typename Weight>
+    void DirectedWeightedGraph<Weight>::SetEdgeWeight(EdgeId edge_id, Weight weight) {
+        if (frozen_) {
+            throw std::logic_error("Graph is frozen");
+        }
+        edges_.at(edge_id).weight = weight;
+    }
+
+    template <typename Weight>
+    void DirectedWeightedGraph<Weight>::SetEdge(EdgeId edge_id, const Edge<Weight>& edge) {
+        if (frozen_) {
+            throw std::logic_error("Graph is frozen");
+        }
+        Edge<Weight>& old_edge = edges_.at(edge_id);
+        if (old_edge.from != edge.from || old_edge.to != edge.to) {
+            throw std::invalid_argument("Edge endpoints can't be changed");
+        }
+        old_edge = edge;
+    }
+
+    template <typename Weight>
+    void DirectedWeightedGraph<Weight>::RemoveEdge(EdgeId edge_id) {
+        static_assert(std::numeric_limits<Weight>::has_infinity, "Removed edges are marked with infinite weight");
+        SetEdgeWeight(edge_id, std::numeric_limits<Weight>::infinity());
+    }
+
+    template <typename Weight>
+    bool DirectedWeightedGraph<Weight>::IsEdgeRemoved(EdgeId edge_id) const {
+        if constexpr (std::numeric_limits<Weight>::has_infinity) {
+            return edges_[edge_id].weight == std::numeric_limits<Weight>::infinity();
+        }else {
+            return false;
+        }
+    }
+
+    template <typename Weight>
+    void DirectedWeightedGraph<Weight>::Freeze() {
+        if (frozen_) {
+            return;
+        }
+        adjacency_ = Adjacency{};
+        adjacency_.offsets.assign(vertex_count_ + 1, 0);
+        adjacency_.targets.reserve(edges_.size());
+        adjacency_.weights.reserve(edges_.size());
+        adjacency_.edge_ids.reserve(edges_.size());
+        // Порядок ребер внутри вершины сохраняется, от него зависит выбор среди путей одинакового веса
+        for (VertexId vertex = 0; vertex < vertex_count_; ++vertex) {
+            for (const uint32_t edge_id : incidence_lists_[vertex]) {
+                if (IsEdgeRemoved(edge_id)) {
+                    continue;
+                }
+                adjacency_.targets.push_back(static_cast<uint32_t>(edges_[edge_id].to));
+                adjacency_.weights.push_back(edges_[edge_id].weight);
+                adjacency_.edge_ids.push_back(edge_id);
+            }
+            adjacency_.offsets[vertex + 1] = static_cast<uint32_t>(adjacency_.edge_ids.size());
+        }
+        std::vector<IncidenceList>().swap(incidence_lists_);
+        frozen_ = true;
+    }
+
+    template <typename Weight>
+    void DirectedWeightedGraph<Weight>::Unfreeze() {
+        if (!frozen_) {
+            return;
+        }
+        incidence_lists_.assign(vertex_count_, IncidenceList{});
+        for (VertexId vertex = 0; vertex < vertex_count_; ++vertex) {
+            incidence_lists_[vertex].assign(adjacency_.edge_ids.begin() + adjacency_.offsets[vertex],
+                adjacency_.edge_ids.begin() + adjacency_.offsets[vertex + 1]);
+        }
+        adjacency_ = Adjacency{};
+        frozen_ = false;
+    }
+
     template <typename Weight>
     size_t DirectedWeightedGraph<Weight>::GetVertexCount() const {
-        return incidence_lists_.size();
+        return vertex_count_;
     }
 
     template <typename Weight>
@@ -70,12 +184,30 @@ namespace graph {
 
     template <typename Weight>
     const Edge<Weight>& DirectedWeightedGraph<Weight>::GetEdge(EdgeId edge_id) const {
-        return edges_.at(edge_id);
+        return edges_[edge_id];
     }
 
     template <typename Weight>
     typename DirectedWeightedGraph<Weight>::IncidentEdgesRange
         DirectedWeightedGraph<Weight>::GetIncidentEdges(VertexId vertex) const {
-        return ranges::AsRange(incidence_lists_.at(vertex));
+        if (frozen_) {
+            const uint32_t* edge_ids = adjacency_.edge_ids.data();
+            return IncidentEdgesRange{ edge_ids + adjacency_.offsets[vertex], edge_ids + adjacency_.offsets[vertex + 1] };
+        }
+        const IncidenceList& incidence_list = incidence_lists_[vertex];
+        return IncidentEdgesRange{ incidence_list.data(), incidence_list.data() + incidence_list.size() };
+    }
+
+    template <typename Weight>
+    bool DirectedWeightedGraph<Weight>::IsFrozen() const {
+        return frozen_;
+    }
+
+    template <typename Weight>
+    const typename DirectedWeightedGraph<Weight>::Adjacency& DirectedWeightedGraph<Weight>::GetAdjacency() const {
+        if (!frozen_) {
+            throw std::logic_error("Graph should be frozen");
+        }
+        return adjacency_;
     }
 }  // namespace graph
\ No newline at end of file
@@ -0,0 +1,268 @@
+#pragma once
+
+#include "graph.h"
+#include "router.h"
+#include "contraction_hierarchy.h"
+
+#include <algorithm>
+#include <numeric>
+#include <optional>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace graph {
+
+    template <typename Weight>
+    class HubLabels : public RouteFinder<Weight> {
+    private:
+        using Graph = DirectedWeightedGraph<Weight>;
+        using Hierarchy = typename ContractionHierarchy<Weight>::Hierarchy;
+
+    public:
+        using typename RouteFinder<Weight>::RouteInfo;
+
+        // arc - первое ребро поискового графа на пути от вершины к хабу (для обратных меток - последнее на пути от хаба)
+        struct LabelEntry {
+            VertexId hub;
+            Weight weight;
+            EdgeId arc;
+        };
+
+        // Метки вершины v - entries[offsets[v]] ... entries[offsets[v + 1] - 1], отсортированы по хабу
+        struct LabelSet {
+            std::vector<size_t> offsets;
+            std::vector<LabelEntry> entries;
+        };
+
+        struct Labels {
+            LabelSet forward;
+            LabelSet backward;
+        };
+
+        explicit HubLabels(const Graph& graph);
+        HubLabels(const Graph& graph, Hierarchy&& hierarchy, Labels&& labels);
+
+        std::optional<RouteInfo> BuildRoute(VertexId from, VertexId to) const override;
+        std::optional<Weight> GetRouteWeight(VertexId from, VertexId to) const override;
+        const Hierarchy& GetHierarchy() const;
+        const Labels& GetLabels() const;
+
+    private:
+        using Entries = std::vector<LabelEntry>;
+        struct Range {
+            const LabelEntry* begin;
+            const LabelEntry* end;
+        };
+        struct Meeting {
+            Weight weight;
+            const LabelEntry* forward;
+            const LabelEntry* backward;
+        };
+
+        void BuildLabels();
+        // Собирает метку вершины из меток соседей выше по рангу, для каждого хаба остается минимальный вес
+        static Entries MergeNeighbourLabels(VertexId vertex, const std::vector<size_t>& offsets,
+            const std::vector<typename ContractionHierarchy<Weight>::Arc>& arcs, const std::vector<Entries>& labels);
+        static std::optional<Meeting> FindMeeting(Range forward, Range backward);
+        static Range GetRange(const LabelSet& labels, VertexId vertex);
+        static Range GetRange(const Entries& entries);
+        static const LabelEntry& FindHub(Range range, VertexId hub);
+        static LabelSet Flatten(std::vector<Entries>&& labels);
+
+        ContractionHierarchy<Weight> hierarchy_;
+        Labels labels_;
+    };
+
+    template <typename Weight>
+    HubLabels<Weight>::HubLabels(const Graph& graph)
+        : hierarchy_(graph)
+    {
+        BuildLabels();
+    }
+
+    template <typename Weight>
+    HubLabels<Weight>::HubLabels(const Graph& graph, Hierarchy&& hierarchy, Labels&& labels)
+        : hierarchy_(graph, std::move(hierarchy))
+        , labels_(std::move(labels))
+    {
+        const size_t offsets_size = graph.GetVertexCount() + 1;
+        if (labels_.forward.offsets.size() != offsets_size || labels_.backward.offsets.size() != offsets_size) {
+            throw std::invalid_argument("Hub labels don't match the graph");
+        }
+    }
+
+    template <typename Weight>
+    const typename HubLabels<Weight>::Hierarchy& HubLabels<Weight>::GetHierarchy() const {
+        return hierarchy_.GetHierarchy();
+    }
+
+    template <typename Weight>
+    const typename HubLabels<Weight>::Labels& HubLabels<Weight>::GetLabels() const {
+        return labels_;
+    }
+
+    template <typename Weight>
+    typename HubLabels<Weight>::Entries HubLabels<Weight>::MergeNeighbourLabels(VertexId vertex, const std::vector<size_t>& offsets,
+        const std::vector<typename ContractionHierarchy<Weight>::Arc>& arcs, const std::vector<Entries>& labels) {
+        Entries result = { LabelEntry{ vertex, Weight{}, 0 } };
+        for (size_t i = offsets[vertex]; i < offsets[vertex + 1]; ++i) {
+            const auto& arc = arcs[i];
+            for (const LabelEntry& entry : labels[arc.target]) {
+                result.push_back(LabelEntry{ entry.hub, arc.weight + entry.weight, arc.id });
+            }
+        }
+        std::stable_sort(result.begin(), result.end(), [](const LabelEntry& lhs, const LabelEntry& rhs) {
+            return lhs.hub < rhs.hub;
+        });
+
+        Entries unique;
+        for (const LabelEntry& entry : result) {
+            if (!unique.empty() && unique.back().hub == entry.hub) {
+                if (entry.weight < unique.back().weight) {
+                    unique.back() = entry;
+                }
+                continue;
+            }
+            unique.push_back(entry);
+        }
+        return unique;
+    }
+
+    template <typename Weight>
+    void HubLabels<Weight>::BuildLabels() {
+        const size_t vertex_count = hierarchy_.GetHierarchy().ranks.size();
+        std::vector<VertexId> order(vertex_count);
+        std::iota(order.begin(), order.end(), 0);
+        const auto& ranks = hierarchy_.GetHierarchy().ranks;
+        std::sort(order.begin(), order.end(), [&ranks](VertexId lhs, VertexId rhs) {
+            return ranks[lhs] > ranks[rhs];
+        });
+
+        // Вершины обходятся сверху вниз по рангу, поэтому метки всех соседей выше уже окончательные.
+        // Запись удаляется, если до хаба есть более короткий путь через другой общий хаб.
+        std::vector<Entries> forward(vertex_count);
+        std::vector<Entries> backward(vertex_count);
+        for (const VertexId vertex : order) {
+            Entries forward_candidates = MergeNeighbourLabels(vertex, hierarchy_.forward_offsets_, hierarchy_.forward_arcs_, forward);
+            Entries backward_candidates = MergeNeighbourLabels(vertex, hierarchy_.backward_offsets_, hierarchy_.backward_arcs_, backward);
+
+            auto is_dominated = [](const LabelEntry& entry, Range forward_range, Range backward_range) {
+                const std::optional<Meeting> meeting = FindMeeting(forward_range, backward_range);
+                return meeting && meeting->weight < entry.weight;
+            };
+            for (const LabelEntry& entry : forward_candidates) {
+                if (!is_dominated(entry, GetRange(forward_candidates), GetRange(backward[entry.hub]))) {
+                    forward[vertex].push_back(entry);
+                }
+            }
+            for (const LabelEntry& entry : backward_candidates) {
+                if (!is_dominated(entry, GetRange(forward[entry.hub]), GetRange(backward_candidates))) {
+                    backward[vertex].push_back(entry);
+                }
+            }
+        }
+
+        labels_.forward = Flatten(std::move(forward));
+        labels_.backward = Flatten(std::move(backward));
+    }
+
+    template <typename Weight>
+    typename HubLabels<Weight>::LabelSet HubLabels<Weight>::Flatten(std::vector<Entries>&& labels) {
+        LabelSet result;
+        result.offsets.reserve(labels.size() + 1);
+        result.offsets.push_back(0);
+        for (Entries& entries : labels) {
+            result.entries.insert(result.entries.end(), entries.begin(), entries.end());
+            result.offsets.push_back(result.entries.size());
+            Entries().swap(entries);
+        }
+        return result;
+    }
+
+    template <typename Weight>
+    typename HubLabels<Weight>::Range HubLabels<Weight>::GetRange(const LabelSet& labels, VertexId vertex) {
+        const LabelEntry* data = labels.entries.data();
+        return Range{ data + labels.offsets[vertex], data + labels.offsets[vertex + 1] };
+    }
+
+    template <typename Weight>
+    typename HubLabels<Weight>::Range HubLabels<Weight>::GetRange(const Entries& entries) {
+        return Range{ entries.data(), entries.data() + entries.size() };
+    }
+
+    template <typename Weight>
+    std::optional<typename HubLabels<Weight>::Meeting> HubLabels<Weight>::FindMeeting(Range forward, Range backward) {
+        std::optional<Meeting> result;
+        while (forward.begin != forward.end && backward.begin != backward.end) {
+            if (forward.begin->hub < backward.begin->hub) {
+                ++forward.begin;
+            }else if (backward.begin->hub < forward.begin->hub) {
+                ++backward.begin;
+            }else {
+                const Weight weight = forward.begin->weight + backward.begin->weight;
+                if (!result || weight < result->weight) {
+                    result = Meeting{ weight, forward.begin, backward.begin };
+                }
+                ++forward.begin;
+                ++backward.begin;
+            }
+        }
+        return result;
+    }
+
+    template <typename Weight>
+    const typename HubLabels<Weight>::LabelEntry& HubLabels<Weight>::FindHub(Range range, VertexId hub) {
+        return *std::lower_bound(range.begin, range.end, hub, [](const LabelEntry& entry, VertexId value) {
+            return entry.hub < value;
+        });
+    }
+
+    template <typename Weight>
+    std::optional<Weight> HubLabels<Weight>::GetRouteWeight(VertexId from, VertexId to) const {
+        const size_t vertex_count = labels_.forward.offsets.size() - 1;
+        if (from >= vertex_count || to >= vertex_count) {
+            throw std::out_of_range("Vertex is out of range");
+        }
+        const std::optional<Meeting> meeting = FindMeeting(GetRange(labels_.forward, from), GetRange(labels_.backward, to));
+        if (!meeting) {
+            return std::nullopt;
+        }
+        return meeting->weight;
+    }
+
+    template <typename Weight>
+    std::optional<typename HubLabels<Weight>::RouteInfo> HubLabels<Weight>::BuildRoute(VertexId from, VertexId to) const {
+        const size_t vertex_count = labels_.forward.offsets.size() - 1;
+        if (from >= vertex_count || to >= vertex_count) {
+            throw std::out_of_range("Vertex is out of range");
+        }
+        const std::optional<Meeting> meeting = FindMeeting(GetRange(labels_.forward, from), GetRange(labels_.backward, to));
+        if (!meeting) {
+            return std::nullopt;
+        }
+
+        // Путь до хаба восстанавливается по меткам промежуточных вершин, в каждой из них хаб тот же
+        const VertexId hub = meeting->forward->hub;
+        std::vector<EdgeId> arcs;
+        for (VertexId vertex = from; vertex != hub; ) {
+            const EdgeId arc = FindHub(GetRange(labels_.forward, vertex), hub).arc;
+            arcs.push_back(arc);
+            vertex = hierarchy_.GetArcEnds(arc).second;
+        }
+        const size_t forward_size = arcs.size();
+        for (VertexId vertex = to; vertex != hub; ) {
+            const EdgeId arc = FindHub(GetRange(labels_.backward, vertex), hub).arc;
+            arcs.push_back(arc);
+            vertex = hierarchy_.GetArcEnds(arc).first;
+        }
+        std::reverse(arcs.begin() + forward_size, arcs.end());
+
+        std::vector<EdgeId> edges;
+        for (const EdgeId arc : arcs) {
+            hierarchy_.UnpackArc(arc, edges);
+        }
+        return RouteInfo{ meeting->weight, std::move(edges) };
+    }
+
+}  // namespace graph
@@ -21,6 +21,7 @@ namespace json_reader {
 		std::unordered_map<std::string_view, std::pair<std::deque<std::string_view>, bool>> buses_;
 		std::unordered_map<std::string_view, std::pair<double, double>> stops_;
 		std::vector<domain::DistanceBwStops> stopsDistance_;		
+		void ReadBaseRequests();
 		void PrepareSettings();
 		void PrepareSerializationSettings();
 		void PrepareRenderSettings(const json::Node renderSettings);
@@ -28,10 +29,16 @@ namespace json_reader {
 		void HandleStopQuery(const json::Node& stop, json::Array& saveConatiner);
 		void HandleBusQuery(const json::Node& bus, json::Array& saveConatiner);
 		void HandleMapQuery(const json::Node& map, json::Array& saveConatiner);
-		void HandleRouteQuery(const json::Node& route, json::Array& saveConatiner);		
+		void HandleRouteQuery(const json::Node& route, json::Array& saveConatiner);
+		void HandleJourneyQuery(const json::Node& route, json::Array& saveConatiner);
+		json::Array BuildTripItems(const domain::Trip& trip);
+		void HandleRouteMatrixQuery(const json::Node& matrix, json::Array& saveConatiner);
+		void HandleIsochroneQuery(const json::Node& isochrone, json::Array& saveConatiner);		
 	public:
 		JsonReader(request::RequestHandler& handler, std::istream& input);			
 		void HandleDataBase();
+		//base_requests поверх сохраненной базы: новые остановки и маршруты, замена остановок маршрута, исправление расстояний
+		void HandleUpdates();
 		void HandleQuery();
 		void Print(std::ostream& output);
 		std::string_view GetSerializePath();
@@ -2,6 +2,7 @@
 
 #include "svg.h"
 #include "domain.h"
+#include "transport_catalogue.h"
 
 #include <iostream>
 #include <deque>
@@ -84,14 +85,14 @@ namespace render {
 	class MapRenderer {	
 	private:
 		std::unordered_map<std::string, domain::SettingType> settings_;
-		const std::set<const domain::Stop*, domain::StopCompare> GetAllStops(const std::deque<const domain::Bus*>& routes, std::unordered_set<geo::Coordinates, geo::CoordinateshHasher>& allCoord);
+		std::vector<uint32_t> GetAllStops(const std::deque<const domain::Bus*>& routes, const transport::catalog::TransportCatalogue& catalog, std::unordered_set<geo::Coordinates, geo::CoordinateshHasher>& allCoord);
 		std::pair<svg::Text, svg::Text> DrawText(const std::string name, svg::Point point, svg::Color color, bool isBus = true);
 		svg::Circle DrawCircle(svg::Point point);
 	public:
 		MapRenderer() = default;
 		void SetSettings(std::unordered_map<std::string, domain::SettingType> settings);
 		const std::unordered_map<std::string, domain::SettingType>& GetSettings();
-		void Draw(std::ostream& out, std::deque<const domain::Bus*> routes);		
+		void Draw(std::ostream& out, transport::catalog::TransportCatalogue& catalog);		
 	};
 }
 }
\ No newline at end of file
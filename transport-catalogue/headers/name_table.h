@@ -0,0 +1,134 @@
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+namespace transport {
+namespace catalog {
+	//Хранилище байтов имен блоками: сохраненное имя не переезжает, поэтому string_view на него действует до уничтожения арены
+	class StringArena {
+	public:
+		std::string_view Store(std::string_view text) {
+			if (text.empty()) {
+				return {};
+			}
+			if (blocks_.empty() || blockUsed_ + text.size() > blockSize_) {
+				//Длинное имя получает отдельный блок своего размера
+				blockSize_ = std::max(BLOCK_SIZE, text.size());
+				blocks_.push_back(std::make_unique<char[]>(blockSize_));
+				blockUsed_ = 0;
+			}
+			char* place = blocks_.back().get() + blockUsed_;
+			std::memcpy(place, text.data(), text.size());
+			blockUsed_ += text.size();
+			return { place, text.size() };
+		}
+
+	private:
+		static constexpr size_t BLOCK_SIZE = 64 * 1024;
+
+		std::vector<std::unique_ptr<char[]>> blocks_;
+		size_t blockSize_ = 0;
+		size_t blockUsed_ = 0;
+	};
+
+	//Имена с id по порядку добавления: таблица id -> имя и поиск имя -> id открытой адресацией.
+	//Хеш имени считается один раз при добавлении, при поиске сначала сравниваются хеши, при перестройке строки не перечитываются.
+	//Повторно добавленное имя получает новый id, его байты в арене не копируются, а поиск возвращает последний id
+	class NameTable {
+	public:
+		static constexpr uint32_t NO_ID = std::numeric_limits<uint32_t>::max();
+
+		uint32_t Add(std::string_view name, StringArena& arena) {
+			if ((used_ + 1) * 2 > slots_.size()) {
+				Rehash(slots_.empty() ? MIN_CAPACITY : slots_.size() * 2);
+			}
+			const size_t hash = std::hash<std::string_view>{}(name);
+			const uint32_t id = static_cast<uint32_t>(names_.size());
+			size_t index = FindSlot(name, hash);
+			if (slots_[index] == NO_ID) {
+				names_.push_back(arena.Store(name));
+				++used_;
+			}else {
+				names_.push_back(names_[slots_[index]]);
+			}
+			hashes_.push_back(hash);
+			slots_[index] = id;
+			return id;
+		}
+
+		uint32_t Find(std::string_view name) const {
+			if (slots_.empty()) {
+				return NO_ID;
+			}
+			return slots_[FindSlot(name, std::hash<std::string_view>{}(name))];
+		}
+
+		std::string_view GetName(uint32_t id) const {
+			return names_[id];
+		}
+
+		//Обходит id, которые находит поиск по имени, то есть по одному на каждое различное имя
+		template <typename Action>
+		void ForEachFound(Action action) const {
+			for (uint32_t id : slots_) {
+				if (id != NO_ID) {
+					action(id);
+				}
+			}
+		}
+
+		void Reserve(size_t count) {
+			names_.reserve(count);
+			hashes_.reserve(count);
+			size_t capacity = MIN_CAPACITY;
+			while (capacity < count * 2) {
+				capacity *= 2;
+			}
+			if (capacity > slots_.size()) {
+				Rehash(capacity);
+			}
+		}
+
+	private:
+		static constexpr size_t MIN_CAPACITY = 16;
+
+		//Ячейка с этим именем или пустая ячейка, где оно должно лежать
+		size_t FindSlot(std::string_view name, size_t hash) const {
+			size_t index = hash & mask_;
+			while (slots_[index] != NO_ID && (hashes_[slots_[index]] != hash || names_[slots_[index]] != name)) {
+				index = (index + 1) & mask_;
+			}
+			return index;
+		}
+
+		void Rehash(size_t capacity) {
+			std::vector<uint32_t> old = std::move(slots_);
+			slots_.assign(capacity, NO_ID);
+			mask_ = capacity - 1;
+			for (uint32_t id : old) {
+				if (id == NO_ID) {
+					continue;
+				}
+				size_t index = hashes_[id] & mask_;
+				while (slots_[index] != NO_ID) {
+					index = (index + 1) & mask_;
+				}
+				slots_[index] = id;
+			}
+		}
+
+		std::vector<std::string_view> names_;
+		std::vector<size_t> hashes_;
+		std::vector<uint32_t> slots_;
+		size_t used_ = 0;
+		size_t mask_ = 0;
+	};
+}
+}
@@ -0,0 +1,98 @@
+#pragma once
+
+#include "fixed_weight.h"
+#include "graph.h"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace graph {
+
+    // Число значащих битов: 0 для нуля, иначе номер старшего единичного бита плюс один
+    inline size_t BitWidth(uint64_t value) {
+#ifdef _MSC_VER
+        unsigned long index;
+        return _BitScanReverse64(&index, value) ? index + 1 : 0;
+#else
+        return value == 0 ? 0 : 64 - __builtin_clzll(value);
+#endif
+    }
+
+    inline uint64_t RadixKey(FixedWeight weight) {
+        return weight.ticks;
+    }
+
+    // Монотонная очередь с приоритетом для Дейкстры: извлеченные ключи не убывают, новый ключ не меньше последнего извлеченного.
+    // Элемент лежит в корзине по старшему биту, которым его ключ отличается от последнего минимума, сравнения весов не нужны.
+    // Интерфейс как у std::priority_queue с std::greater, порядок элементов с равными весами не определен
+    template <typename Weight>
+    class RadixHeap {
+    public:
+        using value_type = std::pair<Weight, VertexId>;
+
+        bool empty() const {
+            return size_ == 0;
+        }
+
+        void push(const value_type& item) {
+            const uint64_t key = RadixKey(item.first);
+            if (key < last_) {
+                throw std::logic_error("Radix heap keys must not decrease");
+            }
+            buckets_[GetBucket(key)].push_back(item);
+            ++size_;
+        }
+
+        const value_type& top() {
+            if (buckets_[0].empty()) {
+                Redistribute();
+            }
+            return buckets_[0].back();
+        }
+
+        void pop() {
+            if (buckets_[0].empty()) {
+                Redistribute();
+            }
+            buckets_[0].pop_back();
+            --size_;
+        }
+
+    private:
+        using Bucket = std::vector<value_type>;
+
+        size_t GetBucket(uint64_t key) const {
+            return BitWidth(key ^ last_);
+        }
+
+        // Ближайшая непустая корзина раскладывается заново от своего минимума, он попадает в нулевую корзину
+        void Redistribute() {
+            size_t bucket = 1;
+            while (buckets_[bucket].empty()) {
+                ++bucket;
+            }
+            Bucket items = std::move(buckets_[bucket]);
+            buckets_[bucket].clear();
+            last_ = RadixKey(items.front().first);
+            for (const value_type& item : items) {
+                last_ = std::min(last_, RadixKey(item.first));
+            }
+            for (const value_type& item : items) {
+                buckets_[GetBucket(RadixKey(item.first))].push_back(item);
+            }
+        }
+
+        std::array<Bucket, 65> buckets_;
+        uint64_t last_ = 0;
+        size_t size_ = 0;
+    };
+
+}  // namespace graph
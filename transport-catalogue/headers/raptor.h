@@ -0,0 +1,58 @@
+#pragma once
+#include "domain.h"
+#include "transport_catalogue.h"
+
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace transport {
+namespace route {
+	//Маршрут с не более чем transfers пересадками, быстрее всех маршрутов с меньшим числом пересадок
+	struct Journey {
+		int transfers = 0;
+		domain::Trip trip;
+	};
+
+	//Поиск по раундам (RAPTOR): в раунде k известны лучшие времена прибытия не более чем с k поездками,
+	//следующий раунд просматривает рейсы через остановки, улучшенные в предыдущем.
+	//Работает прямо по последовательностям остановок маршрутов, граф не нужен
+	class Raptor {
+	public:
+		Raptor(transport::catalog::TransportCatalogue& catalog, double waitTime, double velocity);
+		//Парето-множество по времени и числу пересадок, по возрастанию числа пересадок; пустое, если маршрута нет
+		std::vector<Journey> FindJourneys(const domain::Stop* from, const domain::Stop* to, size_t maxTransfers) const;
+
+	private:
+		static constexpr double INFINITE_TIME = std::numeric_limits<double>::infinity();
+		static constexpr uint32_t NO_PATTERN = std::numeric_limits<uint32_t>::max();
+
+		//Рейс patternId: сели на позиции boardPos, вышли на alightPos
+		struct Label {
+			uint32_t patternId = NO_PATTERN;
+			uint32_t boardPos = 0;
+			uint32_t alightPos = 0;
+		};
+		struct StopPattern {
+			uint32_t patternId;
+			uint32_t position;
+		};
+
+		void AddPattern(const domain::Bus* bus, const std::vector<uint32_t>& stops, transport::catalog::TransportCatalogue& catalog);
+		domain::Trip RestoreTrip(const std::vector<std::vector<Label>>& labels, size_t round, uint32_t from, uint32_t to) const;
+
+		double waitTime_;
+		double metersPerMinute_;
+		std::vector<const domain::Stop*> stops_;
+		//Рейс - направление маршрута, его остановки patternStops_[patternOffsets_[p]] ... patternStops_[patternOffsets_[p + 1] - 1],
+		//rideTimes_ - время от предыдущей остановки рейса
+		std::vector<const domain::Bus*> patternBuses_;
+		std::vector<uint32_t> patternOffsets_ = { 0 };
+		std::vector<uint32_t> patternStops_;
+		std::vector<double> rideTimes_;
+		//Рейсы через остановку s - stopPatterns_[stopOffsets_[s]] ... stopPatterns_[stopOffsets_[s + 1] - 1]
+		std::vector<uint32_t> stopOffsets_;
+		std::vector<StopPattern> stopPatterns_;
+	};
+}
+}
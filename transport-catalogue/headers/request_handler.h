@@ -27,14 +27,26 @@ namespace request {
 			const std::unordered_map<std::string_view, std::pair<double, double>>& stops, 
 			const std::vector<domain::DistanceBwStops>& stopsDistance);
 		void MakeBase();
+		//Загружает базу, применяет изменения и сохраняет ее обратно
+		void UpdateBase(const std::unordered_map<std::string_view, std::pair<std::deque<std::string_view>, bool>>& buses,
+			const std::unordered_map<std::string_view, std::pair<double, double>>& stops,
+			const std::vector<domain::DistanceBwStops>& stopsDistance);
 		void ProcessRequest();
 		const domain::Route GetRoute(const std::string_view& busName);
 		std::optional<const std::deque<std::string_view>> GetStopBuses(const std::string_view& stopName);
 		void SetRenderSettings(std::unordered_map<std::string, domain::SettingType> settings);
-		void SetRouteSettings(std::unordered_map<std::string, double> settings);
+		void SetRouteSettings(std::unordered_map<std::string, double> settings, const route::RoutingOptions& options);
 		void SetSerializationSettings(std::unordered_map<std::string, std::string_view> settings);
 		void CreateRoute();
-		const std::optional<domain::Trip>& FindRoute(std::string_view from, std::string_view to);
+		size_t GetPrunedEdgeCount()const;
+		const graph::ComponentIndex& GetComponentIndex()const;
+		const std::optional<domain::Trip>& FindRoute(std::string_view from, std::string_view to, bool timeOnly = false);
+		std::vector<route::Journey> FindJourneys(std::string_view from, std::string_view to, size_t maxTransfers);
+		//nullopt, если какой-то остановки нет в справочнике
+		std::optional<std::vector<std::vector<std::optional<double>>>> BuildRouteMatrix(const std::vector<std::string_view>& from,
+			const std::vector<std::string_view>& to);
+		//nullopt, если остановки нет в справочнике
+		std::optional<std::vector<std::pair<const domain::Stop*, double>>> FindReachableStops(std::string_view from, double maxTime);
 		void DrawMap(std::ostream& out);
 	};
 }
@@ -0,0 +1,130 @@
+#pragma once
+
+#include "graph.h"
+#include "router.h"
+#include "thread_pool.h"
+
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <optional>
+#include <queue>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace graph {
+
+    // Веса путей из from до всех targets одним проходом Дейкстры.
+    // Поиск останавливается, как только все цели извлечены из очереди, сами пути не восстанавливаются
+    template <typename Weight>
+    std::vector<std::optional<Weight>> ComputeRouteWeights(const DirectedWeightedGraph<Weight>& graph, VertexId from,
+        const std::vector<VertexId>& targets) {
+        using QueueItem = std::pair<Weight, VertexId>;
+        static constexpr Weight INFINITE_WEIGHT = std::numeric_limits<Weight>::infinity();
+        const size_t vertex_count = graph.GetVertexCount();
+        if (from >= vertex_count) {
+            throw std::out_of_range("Vertex is out of range");
+        }
+
+        // Для каждой вершины число вхождений в targets, цель может повторяться
+        std::vector<uint32_t> target_counts(vertex_count, 0);
+        for (const VertexId target : targets) {
+            if (target >= vertex_count) {
+                throw std::out_of_range("Vertex is out of range");
+            }
+            ++target_counts[target];
+        }
+        size_t targets_left = targets.size();
+
+        const auto& adjacency = graph.GetAdjacency();
+        std::vector<Weight> weights(vertex_count, INFINITE_WEIGHT);
+        std::priority_queue<QueueItem, std::vector<QueueItem>, std::greater<QueueItem>> queue;
+        weights[from] = Weight{};
+        queue.push({ Weight{}, from });
+        while (!queue.empty() && targets_left > 0) {
+            const auto [weight, vertex] = queue.top();
+            queue.pop();
+            if (weight > weights[vertex]) {
+                continue;
+            }
+            targets_left -= target_counts[vertex];
+            target_counts[vertex] = 0;
+            for (uint32_t i = adjacency.offsets[vertex]; i < adjacency.offsets[vertex + 1]; ++i) {
+                const Weight candidate_weight = weight + adjacency.weights[i];
+                if (candidate_weight < weights[adjacency.targets[i]]) {
+                    weights[adjacency.targets[i]] = candidate_weight;
+                    queue.push({ candidate_weight, adjacency.targets[i] });
+                }
+            }
+        }
+
+        std::vector<std::optional<Weight>> result(targets.size());
+        for (size_t i = 0; i < targets.size(); ++i) {
+            if (weights[targets[i]] != INFINITE_WEIGHT) {
+                result[i] = weights[targets[i]];
+            }
+        }
+        return result;
+    }
+
+    // Вершины, до которых из from можно добраться с весом не больше max_weight, в порядке возрастания веса.
+    // Вершины тяжелее границы не раскрываются
+    template <typename Weight>
+    std::vector<std::pair<VertexId, Weight>> ComputeReachableWeights(const DirectedWeightedGraph<Weight>& graph, VertexId from,
+        Weight max_weight) {
+        using QueueItem = std::pair<Weight, VertexId>;
+        static constexpr Weight INFINITE_WEIGHT = std::numeric_limits<Weight>::infinity();
+        const size_t vertex_count = graph.GetVertexCount();
+        if (from >= vertex_count) {
+            throw std::out_of_range("Vertex is out of range");
+        }
+
+        const auto& adjacency = graph.GetAdjacency();
+        std::vector<Weight> weights(vertex_count, INFINITE_WEIGHT);
+        std::vector<std::pair<VertexId, Weight>> result;
+        std::priority_queue<QueueItem, std::vector<QueueItem>, std::greater<QueueItem>> queue;
+        if (max_weight < Weight{}) {
+            return result;
+        }
+        weights[from] = Weight{};
+        queue.push({ Weight{}, from });
+        while (!queue.empty()) {
+            const auto [weight, vertex] = queue.top();
+            queue.pop();
+            if (weight > weights[vertex]) {
+                continue;
+            }
+            result.push_back({ vertex, weight });
+            for (uint32_t i = adjacency.offsets[vertex]; i < adjacency.offsets[vertex + 1]; ++i) {
+                const Weight candidate_weight = weight + adjacency.weights[i];
+                if (candidate_weight <= max_weight && candidate_weight < weights[adjacency.targets[i]]) {
+                    weights[adjacency.targets[i]] = candidate_weight;
+                    queue.push({ candidate_weight, adjacency.targets[i] });
+                }
+            }
+        }
+        return result;
+    }
+
+    // Матрица весов sources x targets по строкам, строки считаются параллельно.
+    // Если finder задан, веса берутся из него по парам - это выгодно для таблицы всех пар и хабовых меток
+    template <typename Weight>
+    std::vector<std::vector<std::optional<Weight>>> ComputeRouteMatrix(const DirectedWeightedGraph<Weight>& graph,
+        const std::vector<VertexId>& sources, const std::vector<VertexId>& targets,
+        const RouteFinder<Weight>* finder, parallel::ThreadPool& pool) {
+        std::vector<std::vector<std::optional<Weight>>> result(sources.size());
+        pool.ParallelFor(sources.size(), [&](size_t row) {
+            if (finder == nullptr) {
+                result[row] = ComputeRouteWeights(graph, sources[row], targets);
+                return;
+            }
+            result[row].reserve(targets.size());
+            for (const VertexId target : targets) {
+                result[row].push_back(finder->GetRouteWeight(sources[row], target));
+            }
+        });
+        return result;
+    }
+
+}  // namespace graph
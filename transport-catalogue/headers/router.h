@@ -1,12 +1,16 @@
 #pragma once
 
 #include "graph.h"
+#include "thread_pool.h"
 
 #include <algorithm>
 #include <cassert>
 #include <cstdint>
 #include <iterator>
+#include <limits>
 #include <optional>
+#include <queue>
+#include <functional>
 #include <stdexcept>
 #include <unordered_map>
 #include <utility>
@@ -15,103 +19,419 @@
 namespace graph {
 
     template <typename Weight>
-    class Router {
-    private:
-        using Graph = DirectedWeightedGraph<Weight>;
-
+    class RouteFinder {
     public:
-        explicit Router(const Graph& graph);
-
         struct RouteInfo {
             Weight weight;
             std::vector<EdgeId> edges;
         };
 
-        std::optional<RouteInfo> BuildRoute(VertexId from, VertexId to) const;
+        virtual ~RouteFinder() = default;
+        virtual std::optional<RouteInfo> BuildRoute(VertexId from, VertexId to) const = 0;
+        // Только вес маршрута, без восстановления ребер
+        virtual std::optional<Weight> GetRouteWeight(VertexId from, VertexId to) const {
+            std::optional<RouteInfo> route = BuildRoute(from, to);
+            if (!route) {
+                return std::nullopt;
+            }
+            return route->weight;
+        }
+    };
 
+    template <typename StoredWeight>
+    struct RoutesTable {
+        static_assert(std::numeric_limits<StoredWeight>::has_infinity, "Routes table needs a weight type with infinity");
+        static constexpr StoredWeight INFINITE_WEIGHT = std::numeric_limits<StoredWeight>::infinity();
+        static constexpr uint32_t NO_EDGE = std::numeric_limits<uint32_t>::max();
+
+        RoutesTable() = default;
+        explicit RoutesTable(size_t vertex_count)
+            : vertex_count(vertex_count)
+            , weights(vertex_count * vertex_count, INFINITE_WEIGHT)
+            , prev_edges(vertex_count * vertex_count, NO_EDGE) {
+        }
+
+        size_t vertex_count = 0;
+        std::vector<StoredWeight> weights;
+        std::vector<uint32_t> prev_edges;
+    };
+
+    template <typename Weight, typename StoredWeight = Weight>
+    class Router : public RouteFinder<Weight> {
     private:
-        struct RouteInternalData {
-            Weight weight;
-            std::optional<EdgeId> prev_edge;
-        };
-        using RoutesInternalData = std::vector<std::vector<std::optional<RouteInternalData>>>;
+        using Graph = DirectedWeightedGraph<Weight>;
+
+    public:
+        using typename RouteFinder<Weight>::RouteInfo;
+        using RoutesInternalData = RoutesTable<StoredWeight>;
+
+        // Предрасчет идет на пуле вызывающего, отдельный пул не создается
+        Router(const Graph& graph, parallel::ThreadPool& pool);
+        Router(const Graph& graph, RoutesInternalData&& routes_internal_data);
+
+        std::optional<RouteInfo> BuildRoute(VertexId from, VertexId to) const override;
+        std::optional<Weight> GetRouteWeight(VertexId from, VertexId to) const override;
+        const RoutesInternalData& GetRoutesInternalData() const;
+        // Поправка таблицы после изменения графа без смены числа вершин. Граф меняется в два шага, после каждого таблица снова точная:
+        // сначала подорожавшие и удаленные ребра, затем подешевевшие и новые
+        void RepairIncreasedEdges(const std::vector<EdgeId>& edge_ids, parallel::ThreadPool& pool);
+        void RepairDecreasedEdges(const std::vector<EdgeId>& edge_ids, parallel::ThreadPool& pool);
+
+        static size_t EstimateMemory(size_t vertex_count) {
+            return vertex_count * vertex_count * (sizeof(StoredWeight) + sizeof(uint32_t));
+        }
+
+    private:
+        static constexpr StoredWeight INFINITE_WEIGHT = RoutesInternalData::INFINITE_WEIGHT;
+        static constexpr uint32_t NO_EDGE = RoutesInternalData::NO_EDGE;
 
         void InitializeRoutesInternalData(const Graph& graph) {
             const size_t vertex_count = graph.GetVertexCount();
+            if (graph.GetEdgeCount() >= NO_EDGE) {
+                throw std::length_error("Too many edges for the routes table");
+            }
+            const auto& adjacency = graph.GetAdjacency();
             for (VertexId vertex = 0; vertex < vertex_count; ++vertex) {
-                routes_internal_data_[vertex][vertex] = RouteInternalData{ ZERO_WEIGHT, std::nullopt };
-                for (const EdgeId edge_id : graph.GetIncidentEdges(vertex)) {
-                    const auto& edge = graph.GetEdge(edge_id);
-                    if (edge.weight < ZERO_WEIGHT) {
+                StoredWeight* weights = &routes_internal_data_.weights[vertex * vertex_count];
+                uint32_t* prev_edges = &routes_internal_data_.prev_edges[vertex * vertex_count];
+                weights[vertex] = ZERO_WEIGHT;
+                for (uint32_t i = adjacency.offsets[vertex]; i < adjacency.offsets[vertex + 1]; ++i) {
+                    if (adjacency.weights[i] < Weight{}) {
                         throw std::domain_error("Edges' weights should be non-negative");
                     }
-                    auto& route_internal_data = routes_internal_data_[vertex][edge.to];
-                    if (!route_internal_data || route_internal_data->weight > edge.weight) {
-                        route_internal_data = RouteInternalData{ edge.weight, edge_id };
+                    const VertexId next = adjacency.targets[i];
+                    const StoredWeight weight = static_cast<StoredWeight>(adjacency.weights[i]);
+                    if (next != vertex && weights[next] > weight) {
+                        weights[next] = weight;
+                        prev_edges[next] = adjacency.edge_ids[i];
                     }
                 }
             }
         }
 
-        void RelaxRoute(VertexId vertex_from, VertexId vertex_to, const RouteInternalData& route_from,
-            const RouteInternalData& route_to) {
-            auto& route_relaxing = routes_internal_data_[vertex_from][vertex_to];
-            const Weight candidate_weight = route_from.weight + route_to.weight;
-            if (!route_relaxing || candidate_weight < route_relaxing->weight) {
-                route_relaxing = { candidate_weight,
-                                  route_to.prev_edge ? route_to.prev_edge : route_from.prev_edge };
+        // Релаксация блока [rows) x [columns) через вершины [through).
+        // prev_edges[through][to] на конечном пути всегда задан, поэтому выбор ребра не зависит от prev_edges[from][through]
+        void RelaxBlock(size_t vertex_count, VertexId rows_begin, VertexId rows_end, VertexId columns_begin, VertexId columns_end,
+            VertexId through_begin, VertexId through_end) {
+            StoredWeight* const weights = routes_internal_data_.weights.data();
+            uint32_t* const prev_edges = routes_internal_data_.prev_edges.data();
+            for (VertexId vertex_through = through_begin; vertex_through < through_end; ++vertex_through) {
+                const StoredWeight* weights_through = weights + vertex_through * vertex_count;
+                const uint32_t* prev_edges_through = prev_edges + vertex_through * vertex_count;
+                for (VertexId vertex_from = rows_begin; vertex_from < rows_end; ++vertex_from) {
+                    StoredWeight* weights_from = weights + vertex_from * vertex_count;
+                    uint32_t* prev_edges_from = prev_edges + vertex_from * vertex_count;
+                    const StoredWeight weight_from = weights_from[vertex_through];
+                    if (weight_from == INFINITE_WEIGHT) {
+                        continue;
+                    }
+                    for (VertexId vertex_to = columns_begin; vertex_to < columns_end; ++vertex_to) {
+                        const StoredWeight candidate_weight = weight_from + weights_through[vertex_to];
+                        const bool is_better = candidate_weight < weights_from[vertex_to];
+                        weights_from[vertex_to] = is_better ? candidate_weight : weights_from[vertex_to];
+                        prev_edges_from[vertex_to] = is_better ? prev_edges_through[vertex_to] : prev_edges_from[vertex_to];
+                    }
+                }
             }
         }
 
-        void RelaxRoutesInternalDataThroughVertex(size_t vertex_count, VertexId vertex_through) {
-            for (VertexId vertex_from = 0; vertex_from < vertex_count; ++vertex_from) {
-                if (const auto& route_from = routes_internal_data_[vertex_from][vertex_through]) {
-                    for (VertexId vertex_to = 0; vertex_to < vertex_count; ++vertex_to) {
-                        if (const auto& route_to = routes_internal_data_[vertex_through][vertex_to]) {
-                            RelaxRoute(vertex_from, vertex_to, *route_from, *route_to);
+        // Блочный алгоритм Флойда-Уоршелла: на каждой фазе сначала диагональный блок,
+        // затем блоки его строки и столбца, затем все остальные - блоки внутри второго и третьего шагов независимы
+        void RelaxRoutesInternalData(size_t vertex_count, parallel::ThreadPool& pool) {
+            const size_t block_count = (vertex_count + BLOCK_SIZE - 1) / BLOCK_SIZE;
+            auto block_begin = [](size_t block) { return block * BLOCK_SIZE; };
+            auto block_end = [vertex_count](size_t block) { return std::min((block + 1) * BLOCK_SIZE, vertex_count); };
+
+            for (size_t through = 0; through < block_count; ++through) {
+                const VertexId through_begin = block_begin(through);
+                const VertexId through_end = block_end(through);
+                RelaxBlock(vertex_count, through_begin, through_end, through_begin, through_end, through_begin, through_end);
+
+                pool.ParallelFor(block_count * 2, [&](size_t task) {
+                    const size_t block = task / 2;
+                    if (block == through) {
+                        return;
+                    }
+                    if (task % 2 == 0) {
+                        RelaxBlock(vertex_count, through_begin, through_end, block_begin(block), block_end(block), through_begin, through_end);
+                    }else {
+                        RelaxBlock(vertex_count, block_begin(block), block_end(block), through_begin, through_end, through_begin, through_end);
+                    }
+                });
+
+                pool.ParallelFor(block_count, [&](size_t row) {
+                    if (row == through) {
+                        return;
+                    }
+                    for (size_t column = 0; column < block_count; ++column) {
+                        if (column != through) {
+                            RelaxBlock(vertex_count, block_begin(row), block_end(row), block_begin(column), block_end(column), through_begin, through_end);
                         }
                     }
+                });
+            }
+        }
+
+        // Входящие ребра вершины v - sources, weights и edge_ids с offsets[v] до offsets[v + 1]
+        struct ReverseAdjacency {
+            std::vector<uint32_t> offsets;
+            std::vector<uint32_t> sources;
+            std::vector<Weight> weights;
+            std::vector<uint32_t> edge_ids;
+        };
+
+        ReverseAdjacency BuildReverseAdjacency() const {
+            const size_t vertex_count = graph_.GetVertexCount();
+            const auto& adjacency = graph_.GetAdjacency();
+            ReverseAdjacency reverse;
+            reverse.offsets.assign(vertex_count + 1, 0);
+            for (const uint32_t target : adjacency.targets) {
+                ++reverse.offsets[target + 1];
+            }
+            for (VertexId vertex = 0; vertex < vertex_count; ++vertex) {
+                reverse.offsets[vertex + 1] += reverse.offsets[vertex];
+            }
+            reverse.sources.resize(adjacency.targets.size());
+            reverse.weights.resize(adjacency.targets.size());
+            reverse.edge_ids.resize(adjacency.targets.size());
+            std::vector<uint32_t> fill(reverse.offsets.begin(), reverse.offsets.end() - 1);
+            for (VertexId vertex = 0; vertex < vertex_count; ++vertex) {
+                for (uint32_t i = adjacency.offsets[vertex]; i < adjacency.offsets[vertex + 1]; ++i) {
+                    const uint32_t position = fill[adjacency.targets[i]]++;
+                    reverse.sources[position] = static_cast<uint32_t>(vertex);
+                    reverse.weights[position] = adjacency.weights[i];
+                    reverse.edge_ids[position] = adjacency.edge_ids[i];
                 }
             }
+            return reverse;
         }
 
-        static constexpr Weight ZERO_WEIGHT{};
+        // Пересчитывает в строке from только вершины, путь к которым в старом дереве шел через подорожавшее ребро.
+        // Остальные вершины сохраняют точный вес, от них как от границы запускается Дейкстра по затронутым вершинам
+        void RepairRow(VertexId from, const std::vector<bool>& is_increased, const ReverseAdjacency& reverse) {
+            using QueueItem = std::pair<Weight, VertexId>;
+            enum class State : uint8_t { UNKNOWN, KEPT, AFFECTED };
+            const size_t vertex_count = routes_internal_data_.vertex_count;
+            StoredWeight* weights = &routes_internal_data_.weights[from * vertex_count];
+            uint32_t* prev_edges = &routes_internal_data_.prev_edges[from * vertex_count];
+
+            std::vector<State> states(vertex_count, State::UNKNOWN);
+            std::vector<VertexId> affected;
+            std::vector<VertexId> chain;
+            // Состояние вершины наследуется от предка в дереве, цепочка до уже известного предка размечается целиком
+            for (VertexId vertex = 0; vertex < vertex_count; ++vertex) {
+                VertexId current = vertex;
+                State state = State::KEPT;
+                while (true) {
+                    if (states[current] != State::UNKNOWN) {
+                        state = states[current];
+                        break;
+                    }
+                    chain.push_back(current);
+                    const uint32_t edge_id = prev_edges[current];
+                    if (edge_id == NO_EDGE) {
+                        break;
+                    }
+                    if (is_increased[edge_id]) {
+                        state = State::AFFECTED;
+                        break;
+                    }
+                    current = graph_.GetEdge(edge_id).from;
+                }
+                for (const VertexId item : chain) {
+                    states[item] = state;
+                    if (state == State::AFFECTED) {
+                        affected.push_back(item);
+                    }
+                }
+                chain.clear();
+            }
+
+            std::priority_queue<QueueItem, std::vector<QueueItem>, std::greater<QueueItem>> queue;
+            for (const VertexId vertex : affected) {
+                weights[vertex] = INFINITE_WEIGHT;
+                prev_edges[vertex] = NO_EDGE;
+            }
+            for (const VertexId vertex : affected) {
+                for (uint32_t i = reverse.offsets[vertex]; i < reverse.offsets[vertex + 1]; ++i) {
+                    const VertexId source = reverse.sources[i];
+                    if (states[source] != State::AFFECTED && weights[source] != INFINITE_WEIGHT) {
+                        const StoredWeight candidate_weight = weights[source] + static_cast<StoredWeight>(reverse.weights[i]);
+                        if (candidate_weight < weights[vertex]) {
+                            weights[vertex] = candidate_weight;
+                            prev_edges[vertex] = reverse.edge_ids[i];
+                        }
+                    }
+                }
+                if (weights[vertex] != INFINITE_WEIGHT) {
+                    queue.push({ static_cast<Weight>(weights[vertex]), vertex });
+                }
+            }
+
+            const auto& adjacency = graph_.GetAdjacency();
+            while (!queue.empty()) {
+                const auto [weight, vertex] = queue.top();
+                queue.pop();
+                if (weight > static_cast<Weight>(weights[vertex])) {
+                    continue;
+                }
+                for (uint32_t i = adjacency.offsets[vertex]; i < adjacency.offsets[vertex + 1]; ++i) {
+                    const VertexId next = adjacency.targets[i];
+                    if (states[next] != State::AFFECTED) {
+                        continue;
+                    }
+                    const StoredWeight candidate_weight = weights[vertex] + static_cast<StoredWeight>(adjacency.weights[i]);
+                    if (candidate_weight < weights[next]) {
+                        weights[next] = candidate_weight;
+                        prev_edges[next] = adjacency.edge_ids[i];
+                        queue.push({ static_cast<Weight>(candidate_weight), next });
+                    }
+                }
+            }
+        }
+
+        // Новое ребро u -> v улучшает путь s -> t, только если он идет как s -> u -> v -> t.
+        // Строка v и столбец u при этом не меняются, поэтому строки обновляются независимо.
+        // Если ребро не сокращает путь s -> v, то и пути через v дальше оно не сократит
+        void RelaxThroughEdge(EdgeId edge_id, parallel::ThreadPool& pool) {
+            const size_t vertex_count = routes_internal_data_.vertex_count;
+            const Edge<Weight>& edge = graph_.GetEdge(edge_id);
+            const StoredWeight edge_weight = static_cast<StoredWeight>(edge.weight);
+            StoredWeight* const weights = routes_internal_data_.weights.data();
+            uint32_t* const prev_edges = routes_internal_data_.prev_edges.data();
+            const StoredWeight* weights_to = weights + edge.to * vertex_count;
+            const uint32_t* prev_edges_to = prev_edges + edge.to * vertex_count;
+            pool.ParallelFor(vertex_count, [&](size_t from) {
+                StoredWeight* weights_from = weights + from * vertex_count;
+                uint32_t* prev_edges_from = prev_edges + from * vertex_count;
+                const StoredWeight weight_from = weights_from[edge.from];
+                if (from == edge.to || weight_from == INFINITE_WEIGHT || !(weight_from + edge_weight < weights_from[edge.to])) {
+                    return;
+                }
+                const StoredWeight weight_through = weight_from + edge_weight;
+                for (VertexId to = 0; to < vertex_count; ++to) {
+                    const StoredWeight candidate_weight = weight_through + weights_to[to];
+                    if (candidate_weight < weights_from[to]) {
+                        weights_from[to] = candidate_weight;
+                        prev_edges_from[to] = to == edge.to ? static_cast<uint32_t>(edge_id) : prev_edges_to[to];
+                    }
+                }
+            });
+        }
+
+        void CheckGraph() const {
+            if (graph_.GetVertexCount() != routes_internal_data_.vertex_count) {
+                throw std::invalid_argument("Routes data doesn't match the graph");
+            }
+            if (graph_.GetEdgeCount() >= NO_EDGE) {
+                throw std::length_error("Too many edges for the routes table");
+            }
+        }
+
+        static constexpr size_t BLOCK_SIZE = 64;
+        static constexpr StoredWeight ZERO_WEIGHT{};
         const Graph& graph_;
         RoutesInternalData routes_internal_data_;
     };
 
-    template <typename Weight>
-    Router<Weight>::Router(const Graph& graph)
+    template <typename Weight, typename StoredWeight>
+    Router<Weight, StoredWeight>::Router(const Graph& graph, parallel::ThreadPool& pool)
         : graph_(graph)
-        , routes_internal_data_(graph.GetVertexCount(),
-            std::vector<std::optional<RouteInternalData>>(graph.GetVertexCount()))
+        , routes_internal_data_(graph.GetVertexCount())
     {
         InitializeRoutesInternalData(graph);
+        RelaxRoutesInternalData(graph.GetVertexCount(), pool);
+    }
 
+    template <typename Weight, typename StoredWeight>
+    Router<Weight, StoredWeight>::Router(const Graph& graph, RoutesInternalData&& routes_internal_data)
+        : graph_(graph)
+        , routes_internal_data_(std::move(routes_internal_data))
+    {
         const size_t vertex_count = graph.GetVertexCount();
-        for (VertexId vertex_through = 0; vertex_through < vertex_count; ++vertex_through) {
-            RelaxRoutesInternalDataThroughVertex(vertex_count, vertex_through);
+        if (routes_internal_data_.vertex_count != vertex_count
+            || routes_internal_data_.weights.size() != vertex_count * vertex_count
+            || routes_internal_data_.prev_edges.size() != vertex_count * vertex_count) {
+            throw std::invalid_argument("Routes data doesn't match the graph");
         }
     }
 
-    template <typename Weight>
-    std::optional<typename Router<Weight>::RouteInfo> Router<Weight>::BuildRoute(VertexId from,
+    template <typename Weight, typename StoredWeight>
+    const typename Router<Weight, StoredWeight>::RoutesInternalData& Router<Weight, StoredWeight>::GetRoutesInternalData() const {
+        return routes_internal_data_;
+    }
+
+    template <typename Weight, typename StoredWeight>
+    void Router<Weight, StoredWeight>::RepairIncreasedEdges(const std::vector<EdgeId>& edge_ids, parallel::ThreadPool& pool) {
+        CheckGraph();
+        const size_t vertex_count = routes_internal_data_.vertex_count;
+        // Подорожание ребра u -> v касается только строк, в дереве путей которых оно есть, то есть prev_edges[s][v] == ребро
+        std::vector<bool> is_increased(graph_.GetEdgeCount(), false);
+        for (const EdgeId edge_id : edge_ids) {
+            is_increased[edge_id] = true;
+        }
+        std::vector<VertexId> rows;
+        for (VertexId from = 0; from < vertex_count; ++from) {
+            const uint32_t* prev_edges = &routes_internal_data_.prev_edges[from * vertex_count];
+            const bool affected = std::any_of(edge_ids.begin(), edge_ids.end(), [this, prev_edges](EdgeId edge_id) {
+                return prev_edges[graph_.GetEdge(edge_id).to] == edge_id;
+            });
+            if (affected) {
+                rows.push_back(from);
+            }
+        }
+        if (rows.empty()) {
+            return;
+        }
+        const ReverseAdjacency reverse = BuildReverseAdjacency();
+        pool.ParallelFor(rows.size(), [this, &rows, &is_increased, &reverse](size_t i) {
+            RepairRow(rows[i], is_increased, reverse);
+        });
+    }
+
+    template <typename Weight, typename StoredWeight>
+    void Router<Weight, StoredWeight>::RepairDecreasedEdges(const std::vector<EdgeId>& edge_ids, parallel::ThreadPool& pool) {
+        CheckGraph();
+        for (const EdgeId edge_id : edge_ids) {
+            RelaxThroughEdge(edge_id, pool);
+        }
+    }
+
+    template <typename Weight, typename StoredWeight>
+    std::optional<typename Router<Weight, StoredWeight>::RouteInfo> Router<Weight, StoredWeight>::BuildRoute(VertexId from,
         VertexId to) const {
-        const auto& route_internal_data = routes_internal_data_.at(from).at(to);
-        if (!route_internal_data) {
+        const size_t vertex_count = routes_internal_data_.vertex_count;
+        if (from >= vertex_count || to >= vertex_count) {
+            throw std::out_of_range("Vertex is out of range");
+        }
+        const size_t row = from * vertex_count;
+        const StoredWeight weight = routes_internal_data_.weights[row + to];
+        if (weight == INFINITE_WEIGHT) {
             return std::nullopt;
         }
-        const Weight weight = route_internal_data->weight;
         std::vector<EdgeId> edges;
-        for (std::optional<EdgeId> edge_id = route_internal_data->prev_edge;
-            edge_id;
-            edge_id = routes_internal_data_[from][graph_.GetEdge(*edge_id).from]->prev_edge)
+        for (uint32_t edge_id = routes_internal_data_.prev_edges[row + to];
+            edge_id != NO_EDGE;
+            edge_id = routes_internal_data_.prev_edges[row + graph_.GetEdge(edge_id).from])
         {
-            edges.push_back(*edge_id);
+            edges.push_back(edge_id);
         }
         std::reverse(edges.begin(), edges.end());
 
-        return RouteInfo{ weight, std::move(edges) };
+        return RouteInfo{ static_cast<Weight>(weight), std::move(edges) };
+    }
+
+    template <typename Weight, typename StoredWeight>
+    std::optional<Weight> Router<Weight, StoredWeight>::GetRouteWeight(VertexId from, VertexId to) const {
+        const size_t vertex_count = routes_internal_data_.vertex_count;
+        if (from >= vertex_count || to >= vertex_count) {
+            throw std::out_of_range("Vertex is out of range");
+        }
+        const StoredWeight weight = routes_internal_data_.weights[from * vertex_count + to];
+        if (weight == INFINITE_WEIGHT) {
+            return std::nullopt;
+        }
+        return static_cast<Weight>(weight);
     }
 
 }  // namespace graph
\ No newline at end of file
@@ -29,8 +29,20 @@ private:
 
 	serialize::TransportRouter SerializeRouter();
 	serialize::Graph SerializeGraph(const graph::DirectedWeightedGraph<double>& graph);
+	template <typename StoredWeight>
+	serialize::RoutesInternalData SerializeRoutes(const graph::RoutesTable<StoredWeight>& routes);
+	serialize::ContractionHierarchy SerializeHierarchy(const graph::ContractionHierarchy<double>::Hierarchy& hierarchy);
+	serialize::HubLabelSet SerializeHubLabelSet(const graph::HubLabels<double>::LabelSet& labels);
+	serialize::LandmarkTable SerializeLandmarks(const graph::LandmarkTable<double>& landmarks);
+	serialize::ComponentIndex SerializeComponents(const graph::ComponentIndex& components);
 	void DeserializeRouter(serialize::TransportRouter srouter);
 	graph::DirectedWeightedGraph<double> DeserializeGraph(serialize::Graph&& graph);	
+	template <typename StoredWeight>
+	graph::RoutesTable<StoredWeight> DeserializeRoutes(const serialize::RoutesInternalData& ser_routes);
+	graph::ContractionHierarchy<double>::Hierarchy DeserializeHierarchy(const serialize::ContractionHierarchy& ser_hierarchy);
+	graph::HubLabels<double>::LabelSet DeserializeHubLabelSet(const serialize::HubLabelSet& ser_labels);
+	graph::LandmarkTable<double> DeserializeLandmarks(const serialize::LandmarkTable& ser_landmarks);
+	graph::ComponentIndex DeserializeComponents(const serialize::ComponentIndex& ser_components);
 
 	void AddUnderLayerColor(serialize::MapRenderer& smap, const svg::Color& textColor);
 	void AddColorPallete(serialize::MapRenderer& smap, const std::vector<svg::Color>& colorPalette);
@@ -39,6 +51,5 @@ private:
 	transport::render::MapRenderer& map_;
 	transport::route::Router& route_;
 
-	std::unordered_map<int, const transport::domain::Stop*> stopIt;
-	std::unordered_map<int, const transport::domain::Bus*> busIt;
+	std::unordered_map<int, uint32_t> stopIt;
 };
@@ -0,0 +1,169 @@
+#pragma once
+
+#include "graph.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace graph {
+
+    // Компоненты сильной связности и достижимость между ними в графе конденсации.
+    // Компоненты пронумерованы в обратном топологическом порядке: ребра конденсации ведут к меньшим номерам.
+    // Маршруты ищутся только между остановками, поэтому строки достижимости есть лишь у компонент с вершиной остановки:
+    // одиночные вершины ожидания и поездки не раздувают битовые множества
+    struct ComponentIndex {
+        // Выше этого числа компонент с остановками битовые множества не строятся, остается только разбиение на компоненты
+        static constexpr size_t MAX_REACHABILITY_COMPONENTS = 8192;
+        static constexpr uint32_t NO_ROW = std::numeric_limits<uint32_t>::max();
+
+        std::vector<uint32_t> components;
+        size_t component_count = 0;
+        // Номер строки достижимости компоненты, NO_ROW - в компоненте нет остановок
+        std::vector<uint32_t> rows;
+        size_t row_count = 0;
+        // Достижимые компоненты по строкам: строка r - слова reachable[r * GetWordCount()] ... , бит d - компонента со строкой d
+        std::vector<uint64_t> reachable;
+
+        size_t GetWordCount() const {
+            return (row_count + 63) / 64;
+        }
+
+        // false - индекс не строился: компонент с остановками больше MAX_REACHABILITY_COMPONENTS
+        bool HasReachability() const {
+            return !reachable.empty() || row_count == 0;
+        }
+
+        // false - пути точно нет; true - путь есть или индекс не может этого исключить
+        bool IsReachable(VertexId from, VertexId to) const {
+            if (from >= components.size() || to >= components.size()) {
+                return true;
+            }
+            const uint32_t from_component = components[from];
+            const uint32_t to_component = components[to];
+            if (from_component == to_component || reachable.empty() || rows.size() != component_count) {
+                return true;
+            }
+            const uint32_t from_row = rows[from_component];
+            const uint32_t to_row = rows[to_component];
+            if (from_row == NO_ROW || to_row == NO_ROW) {
+                return true;
+            }
+            return (reachable[from_row * GetWordCount() + to_row / 64] >> (to_row % 64)) & 1;
+        }
+    };
+
+    // Алгоритм Тарьяна без рекурсии по CSR замороженного графа, затем объединение множеств достижимости
+    // от стоков конденсации к истокам. Вершины остановок - первые stop_vertex_count вершин графа
+    template <typename Weight>
+    ComponentIndex BuildComponentIndex(const DirectedWeightedGraph<Weight>& graph, size_t stop_vertex_count) {
+        static constexpr uint32_t UNVISITED = std::numeric_limits<uint32_t>::max();
+        const size_t vertex_count = graph.GetVertexCount();
+        const auto& adjacency = graph.GetAdjacency();
+
+        ComponentIndex index;
+        index.components.assign(vertex_count, 0);
+        std::vector<uint32_t> order(vertex_count, UNVISITED);
+        std::vector<uint32_t> low(vertex_count, 0);
+        std::vector<uint32_t> next_edge(vertex_count, 0);
+        std::vector<bool> on_stack(vertex_count, false);
+        std::vector<uint32_t> stack;
+        std::vector<uint32_t> call_stack;
+        // Вершины, сгруппированные по компонентам: компонента c - members[member_offsets[c]] ... members[member_offsets[c + 1] - 1]
+        std::vector<uint32_t> members;
+        std::vector<uint32_t> member_offsets = { 0 };
+        members.reserve(vertex_count);
+        uint32_t counter = 0;
+
+        auto visit = [&](uint32_t vertex) {
+            order[vertex] = low[vertex] = counter++;
+            next_edge[vertex] = adjacency.offsets[vertex];
+            stack.push_back(vertex);
+            on_stack[vertex] = true;
+            call_stack.push_back(vertex);
+        };
+
+        for (uint32_t root = 0; root < vertex_count; ++root) {
+            if (order[root] != UNVISITED) {
+                continue;
+            }
+            visit(root);
+            while (!call_stack.empty()) {
+                const uint32_t vertex = call_stack.back();
+                if (next_edge[vertex] < adjacency.offsets[vertex + 1]) {
+                    const uint32_t target = adjacency.targets[next_edge[vertex]++];
+                    if (order[target] == UNVISITED) {
+                        visit(target);
+                    }else if (on_stack[target]) {
+                        low[vertex] = std::min(low[vertex], order[target]);
+                    }
+                    continue;
+                }
+                call_stack.pop_back();
+                if (!call_stack.empty()) {
+                    low[call_stack.back()] = std::min(low[call_stack.back()], low[vertex]);
+                }
+                if (low[vertex] == order[vertex]) {
+                    uint32_t member;
+                    do {
+                        member = stack.back();
+                        stack.pop_back();
+                        on_stack[member] = false;
+                        index.components[member] = static_cast<uint32_t>(index.component_count);
+                        members.push_back(member);
+                    } while (member != vertex);
+                    member_offsets.push_back(static_cast<uint32_t>(members.size()));
+                    ++index.component_count;
+                }
+            }
+        }
+
+        index.rows.assign(index.component_count, ComponentIndex::NO_ROW);
+        for (VertexId vertex = 0; vertex < std::min(stop_vertex_count, vertex_count); ++vertex) {
+            uint32_t& row = index.rows[index.components[vertex]];
+            if (row == ComponentIndex::NO_ROW) {
+                row = static_cast<uint32_t>(index.row_count++);
+            }
+        }
+        if (index.row_count > ComponentIndex::MAX_REACHABILITY_COMPONENTS) {
+            return index;
+        }
+        const size_t word_count = index.GetWordCount();
+        // Множества строятся для всех компонент, путь к остановке может идти через компоненту без остановок,
+        // сохраняются только строки компонент с остановками
+        std::vector<uint64_t> all_reachable(index.component_count * word_count, 0);
+        // Компонента, последней объединенная в текущую, чтобы не объединять одну и ту же строку по каждому ребру
+        std::vector<uint32_t> merged_into(index.component_count, UNVISITED);
+        for (uint32_t component = 0; component < index.component_count; ++component) {
+            uint64_t* row = all_reachable.data() + component * word_count;
+            const uint32_t own_row = index.rows[component];
+            if (own_row != ComponentIndex::NO_ROW) {
+                row[own_row / 64] |= uint64_t{ 1 } << (own_row % 64);
+            }
+            for (uint32_t i = member_offsets[component]; i < member_offsets[component + 1]; ++i) {
+                const uint32_t vertex = members[i];
+                for (uint32_t j = adjacency.offsets[vertex]; j < adjacency.offsets[vertex + 1]; ++j) {
+                    const uint32_t successor = index.components[adjacency.targets[j]];
+                    if (successor == component || merged_into[successor] == component) {
+                        continue;
+                    }
+                    merged_into[successor] = component;
+                    const uint64_t* successor_row = all_reachable.data() + successor * word_count;
+                    for (size_t word = 0; word < word_count; ++word) {
+                        row[word] |= successor_row[word];
+                    }
+                }
+            }
+        }
+        index.reachable.assign(index.row_count * word_count, 0);
+        for (uint32_t component = 0; component < index.component_count; ++component) {
+            if (index.rows[component] != ComponentIndex::NO_ROW) {
+                std::copy_n(all_reachable.begin() + component * word_count, word_count,
+                    index.reachable.begin() + index.rows[component] * word_count);
+            }
+        }
+        return index;
+    }
+
+}  // namespace graph
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdlib>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace parallel {
+    class ThreadPool {
+    public:
+        // thread_count - общее число потоков вместе с вызывающим, 0 - по числу ядер
+        explicit ThreadPool(size_t thread_count = 0);
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool& operator=(const ThreadPool&) = delete;
+        ~ThreadPool();
+
+        size_t GetThreadCount() const;
+        // Выполняет task(0) ... task(count - 1) и возвращает управление, когда все задачи завершены.
+        // Исключение из задачи пробрасывается вызывающему после остановки всех потоков, остальные задачи могут не выполниться.
+        // Одновременные вызовы из разных потоков выполняются по очереди.
+        // Не реентерабелен: ParallelFor из задачи того же пула приводит к взаимной блокировке
+        void ParallelFor(size_t count, const std::function<void(size_t)>& task);
+
+    private:
+        void Work();
+        void RunTasks();
+
+        std::vector<std::thread> workers_;
+        std::mutex mutex_;
+        std::mutex callMutex_;
+        std::condition_variable start_;
+        std::condition_variable finish_;
+        const std::function<void(size_t)>* task_ = nullptr;
+        std::exception_ptr error_;
+        size_t taskCount_ = 0;
+        std::atomic<size_t> nextTask_ = 0;
+        size_t activeWorkers_ = 0;
+        size_t generation_ = 0;
+        bool stop_ = false;
+    };
+}
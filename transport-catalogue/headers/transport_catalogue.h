@@ -1,37 +1,92 @@
 #pragma once
 #include "geo.h"
 #include "domain.h"
+#include "distance_table.h"
+#include "name_table.h"
 #include <string_view>
 #include <deque>
 #include <unordered_map>
 #include <unordered_set>
+#include <vector>
+#include <cstdint>
 
 namespace transport {
 namespace catalog {
 	class TransportCatalogue {
 	private:
-		std::unordered_map<std::string_view, domain::Bus*> routes;
-		std::unordered_map<std::string_view, domain::Stop*> stops;			
-		std::deque<domain::Stop> stopStorage;
-		std::deque<domain::Bus> busStorage;
-		std::unordered_map<std::pair<const domain::Stop*, const domain::Stop*>, int, domain::StopLengthHasher> distanceBwStops;
+		//Остановки и маршруты лежат в векторах и адресуются по id. Имена хранятся один раз в общей арене,
+		//имена в векторах и таблицах поиска указывают туда и не зависят от переноса векторов
+		StringArena nameArena;
+		NameTable routes;
+		NameTable stops;
+		std::vector<domain::Stop> stopStorage;
+		std::vector<domain::Bus> busStorage;
+		//Остановки всех маршрутов подряд: у маршрута bus - routeStops[bus.firstStop] ... routeStops[bus.firstStop + bus.stopCount - 1].
+		//Замененный список остановок остается в массиве до Freeze, staleRouteStops - сколько таких элементов
+		std::vector<uint32_t> routeStops;
+		size_t staleRouteStops = 0;
+		DistanceTable distanceBwStops;
 		size_t uniqueStopCount = 0;
 		size_t routesStopCount = 0;
+		std::vector<uint32_t> FindStopIds(const std::deque<std::string_view>& stopsName)const;
+		//Маршруты с остановками, отсортированные по имени, и индекс остановка -> маршруты в формате CSR:
+		//маршруты остановки с id s - stopBusIds[stopBusOffsets[s]] ... stopBusIds[stopBusOffsets[s + 1] - 1], тоже по имени.
+		//Любое изменение остановок или маршрутов сбрасывает индекс, он строится заново при первом запросе
+		std::deque<const domain::Bus*> sortedRoutes;
+		std::vector<uint32_t> stopBusOffsets;
+		std::vector<uint32_t> stopBusIds;
+		bool routeIndexReady = false;
+		void BuildRouteIndex();
+
+		//Статистика маршрута считается при добавлении и поправляется при смене расстояний, запрос Bus ее только читает.
+		//Дорожная длина - сумма заданных расстояний, географическая добавка - длина перегонов без расстояния по прямой
+		struct RouteStats {
+			size_t stops = 0;
+			size_t uniqueStops = 0;
+			double roadLength = 0.0;
+			double fallbackLength = 0.0;
+			double geoLength = 0.0;
+		};
+		//Сколько раз маршрут проезжает перегон между парой остановок: forward - от меньшего id к большему, backward - обратно
+		struct SegmentUse {
+			uint32_t busId = 0;
+			uint32_t forward = 0;
+			uint32_t backward = 0;
+		};
+		std::vector<RouteStats> routeStats;
+		//Перегоны по неупорядоченной паре остановок, нужны, чтобы SetDistance поправил только проходящие по ним маршруты
+		std::unordered_map<uint64_t, std::vector<SegmentUse>> segmentBuses;
+		void AddRouteStats(const domain::Bus& bus);
+		void RemoveRouteStats(const domain::Bus& bus);
 	public:
 		explicit TransportCatalogue();
 		void AddStop(std::string_view stopName, const geo::Coordinates coordinates);
 		void AddRoute(std::string_view routeName, std::deque<std::string_view> stopsName, bool loope);
+		void AddRoute(std::string_view routeName, const std::vector<uint32_t>& stopIds, bool loope);
+		//Меняет остановки существующего маршрута с сохранением id, пустой список убирает маршрут из поиска
+		void UpdateRoute(std::string_view routeName, std::deque<std::string_view> stopsName, bool loope);
 		void SetDistance(std::string_view stopFrom, std::string_view stopTo, int distance);
-		const std::deque<domain::Stop>& GetStopStorage();
-		const std::deque<domain::Bus>& GetBusStorage();
-		const std::unordered_map<std::pair<const domain::Stop*, const domain::Stop*>, int, domain::StopLengthHasher>& GetAllDistance();
+		void SetDistance(uint32_t stopFrom, uint32_t stopTo, int distance);
+		//Заранее выделяет таблицу расстояний под count заданных расстояний, чтобы загрузка шла без перестроек
+		void ReserveDistances(size_t count);
+		//Конец загрузки: убирает остатки замененных маршрутов и лишнюю емкость векторов.
+		//Указатели на остановки и маршруты, полученные раньше, после этого недействительны, как и после любого добавления
+		void Freeze();
+		const std::vector<domain::Stop>& GetStopStorage()const;
+		const std::vector<domain::Bus>& GetBusStorage()const;
+		domain::StopIds GetBusStops(const domain::Bus& bus)const;
+		const DistanceTable& GetAllDistance()const;
 		const domain::Bus* BusFind(std::string_view busName)const;
 		const domain::Stop* StopFind(std::string_view stopName)const;
+		//Поиск без исключения для проверки, есть ли остановка
+		bool HasStop(std::string_view stopName)const;
+		//Id маршрутов, которые проезжают перегон между остановками в любую сторону
+		std::vector<uint32_t> GetSegmentBuses(uint32_t stopFrom, uint32_t stopTo)const;
 		const domain::Route GetRoute(std::string_view busName);
 		const std::deque<std::string_view> GetStopBuses(std::string_view stopName);
-		double GetDistance(const domain::Stop* stopFrom, const domain::Stop* stopTo);
-		std::deque<const domain::Bus*> GetAllRoutes();
-		size_t GetUniqueStopCount();
+		double GetDistance(uint32_t stopFrom, uint32_t stopTo)const;
+		const std::deque<const domain::Bus*>& GetAllRoutes();
+		size_t GetUniqueStopCount()const;
 	};
 }	
 }
\ No newline at end of file
@@ -2,6 +2,17 @@
 #include "graph.h"
 #include "domain.h"
 #include "router.h"
+#include "dijkstra_router.h"
+#include "contraction_hierarchy.h"
+#include "hub_labels.h"
+#include "a_star_router.h"
+#include "route_matrix.h"
+#include "thread_pool.h"
+#include "raptor.h"
+#include "fixed_weight.h"
+#include "radix_heap.h"
+#include "strong_components.h"
+#include "geo.h"
 #include "transport_catalogue.h"
 
 #include <unordered_map>
@@ -9,27 +20,160 @@
 #include <string>
 #include <string_view>
 #include <memory>
+#include <optional>
+#include <vector>
+#include <utility>
+#include <functional>
+#include <mutex>
 
 namespace transport {
 namespace route {
+	enum class RoutingEngine {
+		ALL_PAIRS,
+		DIJKSTRA,
+		CONTRACTION_HIERARCHIES,
+		AUTO,
+		HUB_LABELS,
+		A_STAR,
+		RAPTOR
+	};
+
+	//Неизвестное значение - исключение std::invalid_argument, чтобы опечатка не выбрала молча другой движок
+	RoutingEngine ParseRoutingEngine(std::string_view name);
+
+	//STOP_PAIRS - ребро от каждой остановки маршрута до каждой следующей, LINEAR - цепочка вершин поездки с посадкой и высадкой,
+	//FOLDED - как STOP_PAIRS, но без вершин ожидания: ожидание входит в вес ребра поездки, вершин вдвое меньше
+	enum class GraphModel {
+		STOP_PAIRS,
+		LINEAR,
+		FOLDED
+	};
+
+	GraphModel ParseGraphModel(std::string_view name);
+
+	//FIXED - таблица всех пар хранит веса целыми сотыми долями секунды, поиск Дейкстрой идет по поразрядной очереди
+	enum class WeightFormat {
+		FLOATING,
+		FIXED
+	};
+
+	WeightFormat ParseWeightFormat(std::string_view name);
+
+	//Тип веса в таблице всех пар: FLOAT вдвое компактнее DOUBLE
+	enum class TableWeight {
+		DOUBLE,
+		FLOAT
+	};
+
+	TableWeight ParseTableWeight(std::string_view name);
+
+	//Строковые настройки маршрутизации, разобранные один раз при чтении routing_settings.
+	//Без routing_engine движок выбирается по routing_memory_limit, если он задан, иначе предрасчет всех пар
+	struct RoutingOptions {
+		std::optional<RoutingEngine> engine;
+		GraphModel graphModel = GraphModel::STOP_PAIRS;
+		WeightFormat weightFormat = WeightFormat::FLOATING;
+		TableWeight tableWeight = TableWeight::DOUBLE;
+	};
+
+	//Построение и обновление графа - однопоточные. После загрузки FindJourneys, BuildRouteMatrix и FindReachableStops
+	//можно вызывать из нескольких потоков: данные загружаются один раз, пул и RAPTOR создаются под мьютексами,
+	//задачи на общем пуле выполняются по очереди. FindRoute хранит ответ в роутере (GetReadyRoute), его вызовы нужно упорядочивать снаружи
 	class Router {
 	private:
 		std::unordered_map<std::string, double> settings_;
+		RoutingOptions options_;
 		graph::DirectedWeightedGraph<double> graph;
 		std::optional<domain::Trip> readyRoute;
-		std::unique_ptr<graph::Router<double>> routerFinder;
-		void CreateWaitEdge(graph::VertexId fromId, graph::VertexId toId, std::string_view name, double weight);
-		double CalculateEdgeWeight(const transport::domain::Stop* from, const transport::domain::Stop* to, transport::catalog::TransportCatalogue& catalog);
+		std::unique_ptr<graph::RouteFinder<double>> routerFinder;
+		graph::ComponentIndex components_;
+		size_t prunedEdgeCount_ = 0;
+		std::vector<geo::Coordinates> stopCoordinates_;
+		std::unique_ptr<parallel::ThreadPool> pool_;
+		std::mutex poolMutex_;
+		std::unique_ptr<Raptor> raptor_;
+		std::mutex raptorMutex_;
+		std::function<void()> loader_;
+		std::once_flag loaded_;
+		void EnsureLoaded();
+		//Пул потоков создается при первом обращении под мьютексом, число потоков - настройка routing_threads
+		parallel::ThreadPool& GetThreadPool();
+		//Чтение настройки без вставки ключа: вызывается из параллельных задач, отсутствующая настройка равна 0
+		double GetSetting(const std::string& name)const;
+		const Raptor& GetRaptor(transport::catalog::TransportCatalogue& catalog);
+		RoutingEngine SelectEngine();
+		GraphModel GetGraphModel();
+		bool IsFloatRoutesTable();
+		bool IsFixedWeights();
+		void CreateRouterFinder();
+		void CreateComponentIndex();
+		graph::AStarRouter<double>::Heuristic CreateGeoHeuristic();
+		std::vector<uint32_t> GetVertexStops();
+		void CreateStopPairGraph(transport::catalog::TransportCatalogue& catalog);
+		void CreateLinearGraph(transport::catalog::TransportCatalogue& catalog);
+		void CreateWaitEdge(graph::VertexId fromId, graph::VertexId toId, double weight);
+		std::vector<graph::Edge<double>> CreateBusEdges(const domain::Bus* bus, transport::catalog::TransportCatalogue& catalog);
+		//Ребра маршрутов строятся параллельно в отдельные буферы и склеиваются в порядке маршрутов - номера ребер те же, что при построении в один поток
+		std::vector<graph::Edge<double>> CreateAllBusEdges(const std::deque<const domain::Bus*>& buses, transport::catalog::TransportCatalogue& catalog);
+		//Оставляет на каждую пару вершин одно самое дешевое ребро, возвращает число отброшенных
+		size_t PruneParallelEdges(std::vector<graph::Edge<double>>& edges);
+		double CalculateEdgeWeight(uint32_t from, uint32_t to, transport::catalog::TransportCatalogue& catalog);
 
 	public:
 		Router() = default;
-		void SetSettings(std::unordered_map<std::string, double>&& settings);
+		//Загрузка данных маршрутизации откладывается до первого обращения к графу или поиску, loader выполнится один раз
+		void SetLoader(std::function<void()> loader);
+		void SetSettings(std::unordered_map<std::string, double>&& settings, const RoutingOptions& options);
+		//Координаты остановок по их id, нужны для оценки в A*
+		void SetStopCoordinates(std::vector<geo::Coordinates>&& coordinates);
 		void SetGraph(graph::DirectedWeightedGraph<double>&& graph_);
+		template <typename StoredWeight>
+		void SetGraph(graph::DirectedWeightedGraph<double>&& graph_, graph::RoutesTable<StoredWeight>&& routes);
+		void SetGraph(graph::DirectedWeightedGraph<double>&& graph_, graph::ContractionHierarchy<double>::Hierarchy&& hierarchy);
+		void SetGraph(graph::DirectedWeightedGraph<double>&& graph_, graph::ContractionHierarchy<double>::Hierarchy&& hierarchy,
+			graph::HubLabels<double>::Labels&& labels);
+		void SetGraph(graph::DirectedWeightedGraph<double>&& graph_, graph::LandmarkTable<double>&& landmarks);
+		//Компоненты сильной связности графа: маршрут между разными островами сети отсекается без поиска
+		void SetComponentIndex(graph::ComponentIndex&& components);
+		//Отказ от битовых множеств достижимости виден по GetComponentIndex().HasReachability()
+		const graph::ComponentIndex& GetComponentIndex()const;
+		//Сколько параллельных ребер отброшено при последнем построении графа
+		size_t GetPrunedEdgeCount()const;
 		const std::unordered_map<std::string, double>& GetSettings();
+		const RoutingOptions& GetRoutingOptions();
 		const graph::DirectedWeightedGraph<double>& GetGraph();
+		template <typename StoredWeight>
+		const graph::Router<double, StoredWeight>* GetAllPairsRouter()const;
+		const graph::ContractionHierarchy<double>* GetContractionHierarchy()const;
+		const graph::HubLabels<double>* GetHubLabels()const;
+		const graph::AStarRouter<double>* GetAStarRouter()const;
 		void CreateRoutes(transport::catalog::TransportCatalogue& catalog);
-		void FindRoute(const domain::Stop* from, const domain::Stop* to);
+		//Перестраивает ребра изменившихся маршрутов и поправляет готовую таблицу всех пар вместо полного пересчета,
+		//busIds - изменившиеся маршруты, нужны для ребер ожидания на остановках, где раньше не было маршрутов
+		void UpdateRoutes(transport::catalog::TransportCatalogue& catalog, const std::vector<uint32_t>& busIds);
+		//timeOnly - считается только общее время, без списка действий
+		void FindRoute(const domain::Stop* from, const domain::Stop* to, transport::catalog::TransportCatalogue& catalog, bool timeOnly = false);
 		const std::optional<domain::Trip>& GetReadyRoute()const;
+		//Быстрейшие маршруты с не более чем maxTransfers пересадками, по одному на каждое число пересадок, где время улучшается
+		std::vector<Journey> FindJourneys(const domain::Stop* from, const domain::Stop* to, size_t maxTransfers,
+			transport::catalog::TransportCatalogue& catalog);
+		//Матрица общего времени from x to, nullopt - маршрута нет
+		std::vector<std::vector<std::optional<double>>> BuildRouteMatrix(const std::vector<const domain::Stop*>& from,
+			const std::vector<const domain::Stop*>& to);
+		//Остановки, до которых из from можно доехать не дольше maxTime, с временем в пути по возрастанию
+		std::vector<std::pair<const domain::Stop*, double>> FindReachableStops(const domain::Stop* from, double maxTime,
+			transport::catalog::TransportCatalogue& catalog);
 	};
+
+	template <typename StoredWeight>
+	void Router::SetGraph(graph::DirectedWeightedGraph<double>&& graph_, graph::RoutesTable<StoredWeight>&& routes) {
+		graph = std::move(graph_);
+		routerFinder = std::make_unique<graph::Router<double, StoredWeight>>(graph, std::move(routes));
+	}
+
+	template <typename StoredWeight>
+	const graph::Router<double, StoredWeight>* Router::GetAllPairsRouter()const {
+		return dynamic_cast<const graph::Router<double, StoredWeight>*>(routerFinder.get());
+	}
 }
 }
\ No newline at end of file
@@ -15,6 +15,7 @@
 #include <variant>
 #include <sstream>
 #include <filesystem>
+#include <algorithm>
 
 using namespace std::string_literals;
 
@@ -26,6 +27,17 @@ namespace json_reader {
 	}
 
 	void JsonReader::HandleDataBase() {		
+		ReadBaseRequests();
+		handler_.CreateCatalog(buses_, stops_, stopsDistance_);
+		PrepareSettings();
+	}
+
+	void JsonReader::HandleUpdates() {
+		ReadBaseRequests();
+		handler_.UpdateBase(buses_, stops_, stopsDistance_);
+	}
+
+	void JsonReader::ReadBaseRequests() {
 		for (const json::Node& item : jsonObject_.GetRoot().AsMap().at("base_requests").AsArray()) {
 			const std::string& type = item.AsMap().at("type").AsString();
 			const std::string& name = item.AsMap().at("name").AsString();
@@ -49,8 +61,6 @@ namespace json_reader {
 				buses_[name] = { busStops, item.AsMap().at("is_roundtrip").AsBool() };
 			}
 		}
-		handler_.CreateCatalog(buses_, stops_, stopsDistance_);
-		PrepareSettings();
 	}
 
 	void JsonReader::HandleQuery() {
@@ -69,6 +79,12 @@ namespace json_reader {
 			else if (type == "Route") {
 				HandleRouteQuery(item, result);
 			}
+			else if (type == "RouteMatrix") {
+				HandleRouteMatrixQuery(item, result);
+			}
+			else if (type == "Isochrone") {
+				HandleIsochroneQuery(item, result);
+			}
 		}
 		nodeResul_ = json::Node(result);
 	}
@@ -143,13 +159,30 @@ namespace json_reader {
 
 	void JsonReader::PrepareRouteSettings(const json::Node routeSettings) {
 		std::unordered_map<std::string, double> settings;
+		route::RoutingOptions options;
 
 		for (const auto& [key, value] : routeSettings.AsMap()) {
+			if (key == "routing_engine" && value.IsString()) {
+				options.engine = route::ParseRoutingEngine(value.AsString());
+			}
+
+			if (key == "routing_graph" && value.IsString()) {
+				options.graphModel = route::ParseGraphModel(value.AsString());
+			}
+
+			if (key == "routing_weights" && value.IsString()) {
+				options.weightFormat = route::ParseWeightFormat(value.AsString());
+			}
+
+			if (key == "routing_table_weight" && value.IsString()) {
+				options.tableWeight = route::ParseTableWeight(value.AsString());
+			}
+
 			if (value.IsDouble()) {
 				settings[key] = value.AsDouble();
 			}
 		}
-		handler_.SetRouteSettings(settings);
+		handler_.SetRouteSettings(settings, options);
 	}	
 
 	void JsonReader::HandleStopQuery(const json::Node& stop, json::Array& saveConatiner){
@@ -233,34 +266,54 @@ namespace json_reader {
 		.Build());
 	}
 
+	json::Array JsonReader::BuildTripItems(const domain::Trip& trip) {
+		json::Array routeItems;
+		for (const domain::TripAction& item : trip.items) {
+			json::Builder builder = json::Builder{};
+			auto itemBuilder = builder.StartDict();
+			if (item.type == "Wait") {
+				itemBuilder.Key("stop_name"s).Value(std::string(item.stopBusName));
+			}else {
+				itemBuilder.Key("bus"s)
+					.Value(std::string(item.stopBusName))
+					.Key("span_count"s)
+					.Value(item.spanCount);
+			}
+			itemBuilder.Key("time"s)
+				.Value(item.time)
+				.Key("type"s)
+				.Value(item.type)
+			.EndDict();
+
+			json::Node readyResult = builder.Build();
+			routeItems.push_back(readyResult);
+		}
+		return routeItems;
+	}
+
 	void JsonReader::HandleRouteQuery(const json::Node& route, json::Array& saveConatiner) {
+		if (route.AsMap().count("max_transfers")) {
+			HandleJourneyQuery(route, saveConatiner);
+			return;
+		}
 		int id = route.AsMap().at("id").AsInt();
 		std::string_view from = route.AsMap().at("from").AsString();
 		std::string_view to = route.AsMap().at("to").AsString();
-		const std::optional<domain::Trip>& result = handler_.FindRoute(from, to);
-		if (result.has_value()) {
-			json::Array routeItems;
+		auto timeOnlyIt = route.AsMap().find("time_only");
+		bool timeOnly = timeOnlyIt != route.AsMap().end() && timeOnlyIt->second.AsBool();
+		const std::optional<domain::Trip>& result = handler_.FindRoute(from, to, timeOnly);
+		if (result.has_value() && timeOnly) {
+			saveConatiner.push_back(json::Builder{}
+				.StartDict()
+				.Key("request_id"s)
+				.Value(id)
+				.Key("total_time"s)
+				.Value(result.value().totalTime)
+				.EndDict()
+			.Build());
+		}else if (result.has_value()) {
 			const domain::Trip& trip = result.value();
-			for (const domain::TripAction item : trip.items) {
-				json::Builder builder = json::Builder{};
-				auto itemBuilder = builder.StartDict();
-				if (item.type == "Wait") {
-					itemBuilder.Key("stop_name"s).Value(std::string(item.stopBusName));
-				}else {
-					itemBuilder.Key("bus"s)
-						.Value(std::string(item.stopBusName))
-						.Key("span_count"s)
-						.Value(item.spanCount);
-				}
-				itemBuilder.Key("time"s)
-					.Value(item.time)
-					.Key("type"s)
-					.Value(item.type)
-				.EndDict();
-				
-				json::Node readyResult = builder.Build();
-				routeItems.push_back(readyResult);
-			}
+			json::Array routeItems = BuildTripItems(trip);
 			saveConatiner.push_back(json::Builder{}
 				.StartDict()
 				.Key("request_id"s)
@@ -283,6 +336,133 @@ namespace json_reader {
 		}
 	}
 
+	//Маршрут с ограничением числа пересадок: лучший вариант и парето-множество по времени и пересадкам
+	void JsonReader::HandleJourneyQuery(const json::Node& route, json::Array& saveConatiner) {
+		int id = route.AsMap().at("id").AsInt();
+		std::string_view from = route.AsMap().at("from").AsString();
+		std::string_view to = route.AsMap().at("to").AsString();
+		int maxTransfers = route.AsMap().at("max_transfers").AsInt();
+		const std::vector<route::Journey> journeys = handler_.FindJourneys(from, to, static_cast<size_t>(std::max(maxTransfers, 0)));
+		if (journeys.empty()) {
+			saveConatiner.push_back(json::Builder{}
+				.StartDict()
+				.Key("request_id"s)
+				.Value(id)
+				.Key("error_message"s)
+				.Value("not found"s)
+			.EndDict()
+			.Build());
+			return;
+		}
+		json::Array pareto;
+		for (const route::Journey& journey : journeys) {
+			pareto.push_back(json::Builder{}
+				.StartDict()
+				.Key("transfers"s)
+				.Value(journey.transfers)
+				.Key("total_time"s)
+				.Value(journey.trip.totalTime)
+				.Key("items"s)
+				.Value(BuildTripItems(journey.trip))
+				.EndDict()
+			.Build());
+		}
+		const domain::Trip& best = journeys.back().trip;
+		saveConatiner.push_back(json::Builder{}
+			.StartDict()
+			.Key("request_id"s)
+			.Value(id)
+			.Key("total_time"s)
+			.Value(best.totalTime)
+			.Key("items"s)
+			.Value(BuildTripItems(best))
+			.Key("pareto"s)
+			.Value(std::move(pareto))
+			.EndDict()
+		.Build());
+	}
+
+	void JsonReader::HandleRouteMatrixQuery(const json::Node& matrix, json::Array& saveConatiner) {
+		int id = matrix.AsMap().at("id").AsInt();
+		std::vector<std::string_view> from;
+		std::vector<std::string_view> to;
+		for (const json::Node& stop : matrix.AsMap().at("from").AsArray()) {
+			from.push_back(stop.AsString());
+		}
+		for (const json::Node& stop : matrix.AsMap().at("to").AsArray()) {
+			to.push_back(stop.AsString());
+		}
+		const std::optional<std::vector<std::vector<std::optional<double>>>> result = handler_.BuildRouteMatrix(from, to);
+		if (!result.has_value()) {
+			saveConatiner.push_back(json::Builder{}
+				.StartDict()
+				.Key("request_id"s)
+				.Value(id)
+				.Key("error_message"s)
+				.Value("not found"s)
+			.EndDict()
+			.Build());
+			return;
+		}
+		//Недостижимые пары - null
+		json::Array rows;
+		rows.reserve(result.value().size());
+		for (const std::vector<std::optional<double>>& row : result.value()) {
+			json::Array times;
+			times.reserve(row.size());
+			for (const std::optional<double>& time : row) {
+				times.push_back(time.has_value() ? json::Node(time.value()) : json::Node(nullptr));
+			}
+			rows.push_back(std::move(times));
+		}
+		saveConatiner.push_back(json::Builder{}
+			.StartDict()
+			.Key("request_id"s)
+			.Value(id)
+			.Key("total_times"s)
+			.Value(std::move(rows))
+			.EndDict()
+		.Build());
+	}
+
+	void JsonReader::HandleIsochroneQuery(const json::Node& isochrone, json::Array& saveConatiner) {
+		int id = isochrone.AsMap().at("id").AsInt();
+		std::string_view from = isochrone.AsMap().at("from").AsString();
+		double maxTime = isochrone.AsMap().at("max_time").AsDouble();
+		const std::optional<std::vector<std::pair<const domain::Stop*, double>>> result = handler_.FindReachableStops(from, maxTime);
+		if (!result.has_value()) {
+			saveConatiner.push_back(json::Builder{}
+				.StartDict()
+				.Key("request_id"s)
+				.Value(id)
+				.Key("error_message"s)
+				.Value("not found"s)
+			.EndDict()
+			.Build());
+			return;
+		}
+		json::Array stops;
+		stops.reserve(result.value().size());
+		for (const auto& [stop, time] : result.value()) {
+			stops.push_back(json::Builder{}
+				.StartDict()
+				.Key("stop_name"s)
+				.Value(std::string(stop->name))
+				.Key("time"s)
+				.Value(time)
+				.EndDict()
+			.Build());
+		}
+		saveConatiner.push_back(json::Builder{}
+			.StartDict()
+			.Key("request_id"s)
+			.Value(id)
+			.Key("stops"s)
+			.Value(std::move(stops))
+			.EndDict()
+		.Build());
+	}
+
 	void JsonReader::Print(std::ostream& output) {
 		json::PrintNode(nodeResul_, output);
 	}
@@ -62,10 +62,11 @@ void svgTest() {
 }
 
 void PrintUsage(std::ostream& stream = std::cerr) {
-	stream << "Usage: transport_catalogue [make_base|process_requests]\n"sv;
+	stream << "Usage: transport_catalogue [make_base [--stats]|update_base|process_requests]\n"sv;
 }
 
-void MakeBase() {
+//printStats - вывести в cerr статистику построения графа
+void MakeBase(bool printStats) {
 	transport::request::RequestHandler handler;
 	std::string inFilename = "D:/Project_C/Yandex_C++/Projects/Sprint9/TransportDirectory/cpp-transport-catalogue/transport-catalogue/Examples/make_base.json";	
 	std::ifstream input;
@@ -74,6 +75,23 @@ void MakeBase() {
 		transport::json_reader::JsonReader reader(handler, input);
 		reader.HandleDataBase();
 		handler.MakeBase();
+		if (printStats) {
+			std::cerr << "Pruned parallel edges: "sv << handler.GetPrunedEdgeCount() << '\n';
+			const graph::ComponentIndex& components = handler.GetComponentIndex();
+			std::cerr << "Components with stops: "sv << components.row_count << ", reachability index: "sv
+				<< (components.HasReachability() ? "on"sv : "off"sv) << '\n';
+		}
+	}
+}
+
+void UpdateBase() {
+	transport::request::RequestHandler handler;
+	std::string inFilename = "D:/Project_C/Yandex_C++/Projects/Sprint9/TransportDirectory/cpp-transport-catalogue/transport-catalogue/Examples/update_base.json";
+	std::ifstream input;
+	input.open(inFilename);
+	if (input.is_open()) {
+		transport::json_reader::JsonReader reader(handler, input);
+		reader.HandleUpdates();
 	}
 }
 
@@ -93,15 +111,22 @@ void ProcessRequests() {
 
 int main(int argc, char* argv[]) {	
 	//ProcessRequests();
-	if (argc != 2) {
+	if (argc < 2 || argc > 3) {
 		PrintUsage();
 		return 1;
 	}
 
 	const std::string_view mode(argv[1]);
+	const std::string_view option(argc == 3 ? argv[2] : "");
+	if (!option.empty() && (mode != "make_base"sv || option != "--stats"sv)) {
+		PrintUsage();
+		return 1;
+	}
 
 	if (mode == "make_base"sv) {		
-		MakeBase();
+		MakeBase(option == "--stats"sv);
+	}else if (mode == "update_base"sv) {
+		UpdateBase();
 	}else if (mode == "process_requests"sv) {		
 		ProcessRequests();
 	}else {
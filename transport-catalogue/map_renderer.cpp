@@ -21,14 +21,22 @@ namespace render {
         return settings_;
     }
 
-    const std::set<const domain::Stop*, domain::StopCompare> MapRenderer::GetAllStops(const std::deque<const domain::Bus*>& routes, std::unordered_set<geo::Coordinates, geo::CoordinateshHasher>& allCoord) {
-        std::set<const domain::Stop*, domain::StopCompare> result;
+    std::vector<uint32_t> MapRenderer::GetAllStops(const std::deque<const domain::Bus*>& routes, const transport::catalog::TransportCatalogue& catalog, std::unordered_set<geo::Coordinates, geo::CoordinateshHasher>& allCoord) {
+        const std::vector<domain::Stop>& stops = catalog.GetStopStorage();
+        std::vector<bool> used(stops.size(), false);
+        std::vector<uint32_t> result;
         for (const domain::Bus* bus : routes) {
-            for (const domain::Stop* stop : bus->stops) {
-                allCoord.insert(stop->coord);
-                result.insert(stop);
+            for (uint32_t stop : catalog.GetBusStops(*bus)) {
+                if (!used[stop]) {
+                    used[stop] = true;
+                    allCoord.insert(stops[stop].coord);
+                    result.push_back(stop);
+                }
             }
         }
+        std::sort(result.begin(), result.end(), [&stops](uint32_t lhs, uint32_t rhs) {
+            return stops[lhs].name < stops[rhs].name;
+        });
         return result;
     }
 
@@ -80,9 +88,11 @@ namespace render {
         return circle;
     }
 
-    void MapRenderer::Draw(std::ostream& out, std::deque<const domain::Bus*> routes) {
+    void MapRenderer::Draw(std::ostream& out, transport::catalog::TransportCatalogue& catalog) {
+        const std::deque<const domain::Bus*>& routes = catalog.GetAllRoutes();
+        const std::vector<domain::Stop>& stops = catalog.GetStopStorage();
         std::unordered_set<geo::Coordinates, geo::CoordinateshHasher> allCoord;
-        const std::set<const domain::Stop*, domain::StopCompare> allStops = GetAllStops(routes, allCoord);
+        const std::vector<uint32_t> allStops = GetAllStops(routes, catalog, allCoord);
         double width = std::get<double>(settings_["width"]);
         double height = std::get<double>(settings_["height"]);
         double padding = std::get<double>(settings_["padding"]);
@@ -101,23 +111,24 @@ namespace render {
             }
 
             svg::Polyline route;
+            domain::StopIds busStops = catalog.GetBusStops(*bus);
 
-            geo::Coordinates firstPoint = bus->stops[0]->coord;
-            geo::Coordinates lastPoint = bus->stops[bus->stops.size() - 1]->coord;                         
-            texts.push_back(DrawText(bus->name, proj(firstPoint), colorPalette[colorIndex]));
+            geo::Coordinates firstPoint = stops[busStops.front()].coord;
+            geo::Coordinates lastPoint = stops[busStops.back()].coord;                         
+            texts.push_back(DrawText(std::string(bus->name), proj(firstPoint), colorPalette[colorIndex]));
             if (!bus->loope && firstPoint != lastPoint) {
-                texts.push_back(DrawText(bus->name, proj(lastPoint), colorPalette[colorIndex]));
+                texts.push_back(DrawText(std::string(bus->name), proj(lastPoint), colorPalette[colorIndex]));
             }
 
                 
-            for (size_t i = 0; i < bus->stops.size(); ++i) {
-                svg::Point stopPoint = proj(bus->stops[i]->coord);
+            for (size_t i = 0; i < busStops.size(); ++i) {
+                svg::Point stopPoint = proj(stops[busStops[i]].coord);
                 route.AddPoint(stopPoint);                    
             }
 
-            if (!bus->loope && bus->stops.size() >= 2) {
-                for (int i = (bus->stops.size() - 2); i >= 0; --i) {
-                    route.AddPoint(proj(bus->stops[i]->coord));
+            if (!bus->loope && busStops.size() >= 2) {
+                for (int i = (busStops.size() - 2); i >= 0; --i) {
+                    route.AddPoint(proj(stops[busStops[i]].coord));
                 }
             }
 
@@ -135,14 +146,14 @@ namespace render {
             doc.Add(text);
         }
 
-        for (const domain::Stop* stop : allStops) {
-            svg::Point stopPoint = proj(stop->coord);
+        for (uint32_t stop : allStops) {
+            svg::Point stopPoint = proj(stops[stop].coord);
             doc.Add(DrawCircle(stopPoint));
         }
 
-        for (const domain::Stop* stop : allStops) {
-            svg::Point stopPoint = proj(stop->coord);
-            std::pair<svg::Text, svg::Text> texts = DrawText(stop->name, stopPoint, svg::Color{ "black" }, false);
+        for (uint32_t stop : allStops) {
+            svg::Point stopPoint = proj(stops[stop].coord);
+            std::pair<svg::Text, svg::Text> texts = DrawText(std::string(stops[stop].name), stopPoint, svg::Color{ "black" }, false);
             doc.Add(texts.first);
             doc.Add(texts.second);
         }
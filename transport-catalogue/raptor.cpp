@@ -0,0 +1,163 @@
+#include "headers/raptor.h"
+#include "headers/domain.h"
+#include "headers/transport_catalogue.h"
+
+#include <algorithm>
+#include <deque>
+#include <limits>
+#include <vector>
+
+namespace transport {
+namespace route {
+	Raptor::Raptor(transport::catalog::TransportCatalogue& catalog, double waitTime, double velocity)
+		: waitTime_(waitTime), metersPerMinute_(velocity * 1000 / 60) {
+		const std::vector<domain::Stop>& stops = catalog.GetStopStorage();
+		stops_.resize(catalog.GetUniqueStopCount());
+		for (const domain::Stop& stop : stops) {
+			stops_[stop.id] = &stop;
+		}
+
+		for (const domain::Bus* bus : catalog.GetAllRoutes()) {
+			domain::StopIds stopIds = catalog.GetBusStops(*bus);
+			std::vector<uint32_t> busStops(stopIds.begin(), stopIds.end());
+			AddPattern(bus, busStops, catalog);
+			if (!bus->loope) {
+				std::reverse(busStops.begin(), busStops.end());
+				AddPattern(bus, busStops, catalog);
+			}
+		}
+
+		//Индекс остановка -> рейсы подсчетом, внутри остановки рейсы идут по возрастанию номера
+		stopOffsets_.assign(stops_.size() + 1, 0);
+		for (const uint32_t stop : patternStops_) {
+			++stopOffsets_[stop + 1];
+		}
+		for (size_t stop = 0; stop < stops_.size(); ++stop) {
+			stopOffsets_[stop + 1] += stopOffsets_[stop];
+		}
+		stopPatterns_.resize(patternStops_.size());
+		std::vector<uint32_t> fill(stopOffsets_.begin(), stopOffsets_.end() - 1);
+		for (uint32_t patternId = 0; patternId < patternBuses_.size(); ++patternId) {
+			for (uint32_t i = patternOffsets_[patternId]; i < patternOffsets_[patternId + 1]; ++i) {
+				stopPatterns_[fill[patternStops_[i]]++] = StopPattern{ patternId, i - patternOffsets_[patternId] };
+			}
+		}
+	}
+
+	void Raptor::AddPattern(const domain::Bus* bus, const std::vector<uint32_t>& stops, transport::catalog::TransportCatalogue& catalog) {
+		if (stops.size() < 2) {
+			return;
+		}
+		patternBuses_.push_back(bus);
+		for (size_t i = 0; i < stops.size(); ++i) {
+			patternStops_.push_back(stops[i]);
+			rideTimes_.push_back(i == 0 ? 0.0 : catalog.GetDistance(stops[i - 1], stops[i]) / metersPerMinute_);
+		}
+		patternOffsets_.push_back(static_cast<uint32_t>(patternStops_.size()));
+	}
+
+	std::vector<Journey> Raptor::FindJourneys(const domain::Stop* from, const domain::Stop* to, size_t maxTransfers) const {
+		const uint32_t source = from->id;
+		const uint32_t target = to->id;
+		if (source == target) {
+			return { Journey{} };
+		}
+
+		const size_t stopCount = stops_.size();
+		const size_t maxRounds = std::min(maxTransfers, patternBuses_.size()) + 1;
+		std::vector<std::vector<double>> arrivals(1, std::vector<double>(stopCount, INFINITE_TIME));
+		std::vector<std::vector<Label>> labels(1, std::vector<Label>(stopCount));
+		arrivals[0][source] = 0;
+		std::vector<double> best = arrivals[0];
+
+		std::vector<uint32_t> markedStops = { source };
+		std::vector<bool> isMarked(stopCount, false);
+		std::vector<uint32_t> patternStart(patternBuses_.size(), NO_PATTERN);
+		std::vector<uint32_t> touchedPatterns;
+		for (size_t round = 1; round <= maxRounds && !markedStops.empty(); ++round) {
+			//Каждый рейс просматривается с самой ранней позиции, где улучшилось время
+			for (const uint32_t stop : markedStops) {
+				isMarked[stop] = false;
+				for (uint32_t i = stopOffsets_[stop]; i < stopOffsets_[stop + 1]; ++i) {
+					const StopPattern& item = stopPatterns_[i];
+					if (patternStart[item.patternId] == NO_PATTERN) {
+						touchedPatterns.push_back(item.patternId);
+						patternStart[item.patternId] = item.position;
+					}else {
+						patternStart[item.patternId] = std::min(patternStart[item.patternId], item.position);
+					}
+				}
+			}
+			markedStops.clear();
+
+			arrivals.push_back(arrivals.back());
+			labels.emplace_back(stopCount);
+			const std::vector<double>& previous = arrivals[round - 1];
+			std::vector<double>& current = arrivals[round];
+			std::vector<Label>& roundLabels = labels[round];
+			for (const uint32_t patternId : touchedPatterns) {
+				const uint32_t offset = patternOffsets_[patternId];
+				const uint32_t size = patternOffsets_[patternId + 1] - offset;
+				double onboard = INFINITE_TIME;
+				uint32_t boardPos = 0;
+				for (uint32_t pos = patternStart[patternId]; pos < size; ++pos) {
+					const uint32_t stop = patternStops_[offset + pos];
+					if (onboard != INFINITE_TIME) {
+						onboard += rideTimes_[offset + pos];
+						//Прибытие хуже уже найденного до цели ничего не даст
+						if (onboard < std::min(best[stop], best[target])) {
+							current[stop] = onboard;
+							best[stop] = onboard;
+							roundLabels[stop] = Label{ patternId, boardPos, pos };
+							if (!isMarked[stop]) {
+								isMarked[stop] = true;
+								markedStops.push_back(stop);
+							}
+						}
+					}
+					if (previous[stop] + waitTime_ < onboard) {
+						onboard = previous[stop] + waitTime_;
+						boardPos = pos;
+					}
+				}
+				patternStart[patternId] = NO_PATTERN;
+			}
+			touchedPatterns.clear();
+		}
+
+		std::vector<Journey> result;
+		for (size_t round = 1; round < arrivals.size(); ++round) {
+			if (arrivals[round][target] < arrivals[round - 1][target]) {
+				result.push_back(Journey{ static_cast<int>(round) - 1, RestoreTrip(labels, round, source, target) });
+			}
+		}
+		return result;
+	}
+
+	domain::Trip Raptor::RestoreTrip(const std::vector<std::vector<Label>>& labels, size_t round, uint32_t from, uint32_t to) const {
+		//Метка в раунде есть, только если время в нем улучшилось, иначе оно унаследовано от предыдущего
+		std::vector<Label> legs;
+		for (uint32_t stop = to; stop != from; --round) {
+			while (labels[round][stop].patternId == NO_PATTERN) {
+				--round;
+			}
+			const Label& label = labels[round][stop];
+			legs.push_back(label);
+			stop = patternStops_[patternOffsets_[label.patternId] + label.boardPos];
+		}
+
+		domain::Trip trip;
+		for (auto legIt = legs.rbegin(); legIt != legs.rend(); ++legIt) {
+			const uint32_t offset = patternOffsets_[legIt->patternId];
+			double rideTime = 0;
+			for (uint32_t pos = legIt->boardPos + 1; pos <= legIt->alightPos; ++pos) {
+				rideTime += rideTimes_[offset + pos];
+			}
+			trip.items.push_back({ "Wait", waitTime_, stops_[patternStops_[offset + legIt->boardPos]]->name, 0 });
+			trip.items.push_back({ "Bus", rideTime, patternBuses_[legIt->patternId]->name, static_cast<int>(legIt->alightPos - legIt->boardPos) });
+			trip.totalTime += waitTime_ + rideTime;
+		}
+		return trip;
+	}
+}
+}
@@ -8,6 +8,7 @@
 #include <utility>
 #include <optional>
 #include <variant>
+#include <algorithm>
 
 namespace transport {
 namespace request {
@@ -25,9 +26,11 @@ namespace request {
 			catalog_.AddRoute(busName, busInfo.first, busInfo.second);
 		}
 
+		catalog_.ReserveDistances(stopsDistance.size());
 		for (const auto& [from, to, distance] : stopsDistance) {
 			catalog_.SetDistance(from, to, distance);
 		}
+		catalog_.Freeze();
 	}
 
 	void RequestHandler::MakeBase() {
@@ -36,6 +39,40 @@ namespace request {
 		ser.Serialize(serialization_["file"]);
 	}
 
+	void RequestHandler::UpdateBase(const std::unordered_map<std::string_view, std::pair<std::deque<std::string_view>, bool>>& buses,
+		const std::unordered_map<std::string_view, std::pair<double, double>>& stops,
+		const std::vector<domain::DistanceBwStops>& stopsDistance) {
+		Serialization ser(catalog_, map_, route_);
+		ser.Deserialize(serialization_["file"]);
+
+		for (const auto& [stopName, coord] : stops) {
+			if (!catalog_.HasStop(stopName)) {
+				catalog_.AddStop(stopName, geo::Coordinates{ coord.first, coord.second });
+			}
+		}
+
+		std::vector<uint32_t> changedBuses;
+		for (const auto& [busName, busInfo] : buses) {
+			catalog_.UpdateRoute(busName, busInfo.first, busInfo.second);
+			changedBuses.push_back(catalog_.BusFind(busName)->id);
+		}
+
+		//Расстояние в одну сторону служит и обратным, если обратное не задано, поэтому маршруты берутся по перегону в любую сторону
+		for (const auto& [from, to, distance] : stopsDistance) {
+			uint32_t fromStop = catalog_.StopFind(from)->id;
+			uint32_t toStop = catalog_.StopFind(to)->id;
+			catalog_.SetDistance(fromStop, toStop, distance);
+			std::vector<uint32_t> segmentBuses = catalog_.GetSegmentBuses(fromStop, toStop);
+			changedBuses.insert(changedBuses.end(), segmentBuses.begin(), segmentBuses.end());
+		}
+
+		std::sort(changedBuses.begin(), changedBuses.end());
+		changedBuses.erase(std::unique(changedBuses.begin(), changedBuses.end()), changedBuses.end());
+		catalog_.Freeze();
+		route_.UpdateRoutes(catalog_, changedBuses);
+		ser.Serialize(serialization_["file"]);
+	}
+
 	void RequestHandler::ProcessRequest() {
 		Serialization ser(catalog_, map_, route_);
 		ser.Deserialize(serialization_["file"]);
@@ -59,8 +96,8 @@ namespace request {
 		map_.SetSettings(settings);
 	}
 
-	void RequestHandler::SetRouteSettings(std::unordered_map<std::string, double> settings) {
-		route_.SetSettings(std::move(settings));
+	void RequestHandler::SetRouteSettings(std::unordered_map<std::string, double> settings, const route::RoutingOptions& options) {
+		route_.SetSettings(std::move(settings), options);
 	}
 
 	void RequestHandler::SetSerializationSettings(std::unordered_map<std::string, std::string_view> settings) {
@@ -71,15 +108,56 @@ namespace request {
 		route_.CreateRoutes(catalog_);
 	}
 
-	const std::optional<domain::Trip>& RequestHandler::FindRoute(std::string_view from, std::string_view to) {
+	size_t RequestHandler::GetPrunedEdgeCount()const {
+		return route_.GetPrunedEdgeCount();
+	}
+
+	const graph::ComponentIndex& RequestHandler::GetComponentIndex()const {
+		return route_.GetComponentIndex();
+	}
+
+	const std::optional<domain::Trip>& RequestHandler::FindRoute(std::string_view from, std::string_view to, bool timeOnly) {
 		const domain::Stop* fromPtr = catalog_.StopFind(from);
 		const domain::Stop* toPtr = catalog_.StopFind(to);
-		route_.FindRoute(fromPtr, toPtr);
+		route_.FindRoute(fromPtr, toPtr, catalog_, timeOnly);
 		return route_.GetReadyRoute();
 	}
 
+	std::vector<route::Journey> RequestHandler::FindJourneys(std::string_view from, std::string_view to, size_t maxTransfers) {
+		const domain::Stop* fromPtr = catalog_.StopFind(from);
+		const domain::Stop* toPtr = catalog_.StopFind(to);
+		return route_.FindJourneys(fromPtr, toPtr, maxTransfers, catalog_);
+	}
+
+	std::optional<std::vector<std::vector<std::optional<double>>>> RequestHandler::BuildRouteMatrix(const std::vector<std::string_view>& from,
+		const std::vector<std::string_view>& to) {
+		std::vector<const domain::Stop*> fromStops;
+		std::vector<const domain::Stop*> toStops;
+		try {
+			for (std::string_view name : from) {
+				fromStops.push_back(catalog_.StopFind(name));
+			}
+			for (std::string_view name : to) {
+				toStops.push_back(catalog_.StopFind(name));
+			}
+		}catch (...) {
+			return std::nullopt;
+		}
+		return route_.BuildRouteMatrix(fromStops, toStops);
+	}
+
+	std::optional<std::vector<std::pair<const domain::Stop*, double>>> RequestHandler::FindReachableStops(std::string_view from, double maxTime) {
+		const domain::Stop* fromPtr = nullptr;
+		try {
+			fromPtr = catalog_.StopFind(from);
+		}catch (...) {
+			return std::nullopt;
+		}
+		return route_.FindReachableStops(fromPtr, maxTime, catalog_);
+	}
+
 	void RequestHandler::DrawMap(std::ostream& out) {
-		map_.Draw(out, catalog_.GetAllRoutes());
+		map_.Draw(out, catalog_);
 	}
 }
 }
\ No newline at end of file
@@ -6,6 +6,8 @@
 #include <variant>
 #include <vector>
 #include <utility>
+#include <type_traits>
+#include <stdexcept>
 
 #include "headers/serialization.h"
 #include "headers/transport_catalogue.h"
@@ -32,18 +34,24 @@ void Serialization::Serialize(const std::filesystem::path& path){
 
 void Serialization::Deserialize(const std::filesystem::path& path){
 	std::ifstream in_file(path, std::ios::binary);
-	serialize::SeriliazeBlock all;	
+	//  ,  SeriliazeBlock,             
+	serialize::LazySeriliazeBlock all;
 	if (all.ParseFromIstream(&in_file)) {
 		DeserializeCatalog(all.catalog());
 		DeserializeMap(all.map());
-		DeserializeRouter(all.router());
+		route_.SetLoader([ser = *this, router = std::move(*all.mutable_router())]() mutable {
+			serialize::TransportRouter srouter;
+			if (srouter.ParseFromString(router)) {
+				ser.DeserializeRouter(std::move(srouter));
+			}
+		});
 	}	
 }
 
 serialize::TransportCatalogue Serialization::SerializeCatalog(){
 	serialize::TransportCatalogue scatalog;
-	const std::deque<transport::domain::Stop>& stops = catalog_.GetStopStorage();
-	const std::deque<transport::domain::Bus>& buses = catalog_.GetBusStorage();
+	const std::vector<transport::domain::Stop>& stops = catalog_.GetStopStorage();
+	const std::vector<transport::domain::Bus>& buses = catalog_.GetBusStorage();
 	const auto & distance = catalog_.GetAllDistance();
 
 	for (const transport::domain::Stop& itemStop : stops) {
@@ -51,7 +59,7 @@ serialize::TransportCatalogue Serialization::SerializeCatalog(){
 		serialize::Coordinates coord;
 		coord.set_lat(itemStop.coord.lat);
 		coord.set_lng(itemStop.coord.lng);
-		protoStop.set_name(itemStop.name);
+		protoStop.set_name(itemStop.name.data(), itemStop.name.size());
 		protoStop.set_id(static_cast<int32_t>(itemStop.id));
 		*protoStop.mutable_coordinates() = coord;
 		*scatalog.add_stopstorage() = protoStop;
@@ -59,22 +67,22 @@ serialize::TransportCatalogue Serialization::SerializeCatalog(){
 
 	for (const transport::domain::Bus& itemBus : buses) {
 		serialize::Bus protoBus;
-		protoBus.set_name(itemBus.name);
+		protoBus.set_name(itemBus.name.data(), itemBus.name.size());
 		protoBus.set_loop(itemBus.loope);
-		for (const transport::domain::Stop *itemStop : itemBus.stops) {
-			protoBus.add_stops(static_cast<int32_t>(itemStop->id));
+		for (uint32_t itemStop : catalog_.GetBusStops(itemBus)) {
+			protoBus.add_stops(static_cast<int32_t>(itemStop));
 		}
 		protoBus.set_id(static_cast<int32_t>(itemBus.id));
 		*scatalog.add_busstorage() = protoBus;
 	}
 
-	for (const auto& [fromTo, length] : distance) {
+	distance.ForEachGiven([&scatalog](uint32_t from, uint32_t to, int length) {
 		serialize::DistanceBwStops protoDistance;
-		protoDistance.set_fromstop(static_cast<int32_t>(fromTo.first->id));
-		protoDistance.set_tostop(static_cast<int32_t>(fromTo.second->id));
+		protoDistance.set_fromstop(static_cast<int32_t>(from));
+		protoDistance.set_tostop(static_cast<int32_t>(to));
 		protoDistance.set_distance(length);
 		*scatalog.add_distance() = protoDistance;
-	}
+	});
 
 	return scatalog;
 }
@@ -83,24 +91,26 @@ void Serialization::DeserializeCatalog(serialize::TransportCatalogue scatalog){
 	const auto stopStorage = scatalog.stopstorage();
 	for (auto it = stopStorage.begin(); it != stopStorage.end(); ++it) {
 		catalog_.AddStop(it->name(), { it->coordinates().lat(), it->coordinates().lng() });
-		stopIt[it->id()] = catalog_.StopFind(it->name());
+		stopIt[it->id()] = catalog_.StopFind(it->name())->id;
 	}
 
 	const auto busStorage = scatalog.busstorage();
 	for (auto it = busStorage.begin(); it != busStorage.end(); ++it) {
-		std::deque<std::string_view> stopsName;
+		std::vector<uint32_t> stopIds;
 		const auto busStops = it->stops();
+		stopIds.reserve(busStops.size());
 		for (auto sit = busStops.begin(); sit != busStops.end(); ++sit) {
-			stopsName.push_back(stopIt.at(*sit)->name);
+			stopIds.push_back(stopIt.at(*sit));
 		}
-		catalog_.AddRoute(it->name(), stopsName, it->loop());	
-		busIt[it->id()] = catalog_.BusFind(it->name());
+		catalog_.AddRoute(it->name(), stopIds, it->loop());	
 	}
 
 	const auto distance = scatalog.distance();
+	catalog_.ReserveDistances(distance.size());
 	for (auto it = distance.begin(); it != distance.end(); ++it) {
-		catalog_.SetDistance(stopIt.at(it->fromstop())->name, stopIt.at(it->tostop())->name, it->distance());
+		catalog_.SetDistance(stopIt.at(it->fromstop()), stopIt.at(it->tostop()), it->distance());
 	}
+	catalog_.Freeze();
 }
 
 serialize::MapRenderer Serialization::SerializeMap() {
@@ -143,44 +153,115 @@ serialize::TransportRouter Serialization::SerializeRouter() {
 	for (const auto& [key, value] : route_.GetSettings()) {
 		(*ser_router.mutable_settings())[key] = value;
 	}
+	const transport::route::RoutingOptions& options = route_.GetRoutingOptions();
+	serialize::RoutingOptions* ser_options = ser_router.mutable_options();
+	ser_options->set_engine_given(options.engine.has_value());
+	ser_options->set_engine(static_cast<uint32_t>(options.engine.value_or(transport::route::RoutingEngine::ALL_PAIRS)));
+	ser_options->set_graph_model(static_cast<uint32_t>(options.graphModel));
+	ser_options->set_weight_format(static_cast<uint32_t>(options.weightFormat));
+	ser_options->set_table_weight(static_cast<uint32_t>(options.tableWeight));
 	
 	*ser_router.mutable_graph() = std::move(ser_graph);	
+
+	if (const auto* allPairs = route_.GetAllPairsRouter<double>()) {
+		*ser_router.mutable_routes() = SerializeRoutes(allPairs->GetRoutesInternalData());
+	}else if (const auto* allPairs = route_.GetAllPairsRouter<float>()) {
+		*ser_router.mutable_routes() = SerializeRoutes(allPairs->GetRoutesInternalData());
+	}else if (const auto* allPairs = route_.GetAllPairsRouter<graph::FixedWeight>()) {
+		*ser_router.mutable_routes() = SerializeRoutes(allPairs->GetRoutesInternalData());
+	}else if (const auto* hierarchy = route_.GetContractionHierarchy()) {
+		*ser_router.mutable_hierarchy() = SerializeHierarchy(hierarchy->GetHierarchy());
+	}else if (const auto* hubLabels = route_.GetHubLabels()) {
+		//    -,      
+		*ser_router.mutable_hierarchy() = SerializeHierarchy(hubLabels->GetHierarchy());
+		*ser_router.mutable_hub_labels()->mutable_forward() = SerializeHubLabelSet(hubLabels->GetLabels().forward);
+		*ser_router.mutable_hub_labels()->mutable_backward() = SerializeHubLabelSet(hubLabels->GetLabels().backward);
+	}else if (const auto* aStar = route_.GetAStarRouter()) {
+		*ser_router.mutable_landmarks() = SerializeLandmarks(aStar->GetLandmarks());
+	}
+	*ser_router.mutable_components() = SerializeComponents(route_.GetComponentIndex());
 	return ser_router;
 }
 
-serialize::Graph Serialization::SerializeGraph(const graph::DirectedWeightedGraph<double>& graph) {
-	serialize::Graph ser_graph;
-	size_t graphSize = graph.GetVertexCount();
-	serialize::EdgeList ser_edges_list;
+serialize::ContractionHierarchy Serialization::SerializeHierarchy(const graph::ContractionHierarchy<double>::Hierarchy& hierarchy) {
+	serialize::ContractionHierarchy ser_hierarchy;
+	ser_hierarchy.mutable_ranks()->Add(hierarchy.ranks.begin(), hierarchy.ranks.end());
+	for (const auto& shortcut : hierarchy.shortcuts) {
+		ser_hierarchy.add_shortcut_from(static_cast<uint32_t>(shortcut.from));
+		ser_hierarchy.add_shortcut_to(static_cast<uint32_t>(shortcut.to));
+		ser_hierarchy.add_shortcut_weight(shortcut.weight);
+		ser_hierarchy.add_shortcut_first(static_cast<uint32_t>(shortcut.first));
+		ser_hierarchy.add_shortcut_second(static_cast<uint32_t>(shortcut.second));
+	}
+	return ser_hierarchy;
+}
 
-	for (size_t i = 0; i < graphSize; ++i) {		
-		auto edgesId = graph.GetIncidentEdges(i);
+serialize::HubLabelSet Serialization::SerializeHubLabelSet(const graph::HubLabels<double>::LabelSet& labels) {
+	serialize::HubLabelSet ser_labels;
+	ser_labels.mutable_offsets()->Add(labels.offsets.begin(), labels.offsets.end());
+	for (const auto& entry : labels.entries) {
+		ser_labels.add_hubs(static_cast<uint32_t>(entry.hub));
+		ser_labels.add_weights(entry.weight);
+		ser_labels.add_arcs(static_cast<uint32_t>(entry.arc));
+	}
+	return ser_labels;
+}
 
-		for (auto it = edgesId.begin(); it != edgesId.end(); ++it) {
-			const graph::Edge<double>& edge = graph.GetEdge(*it);
-			serialize::Edge* ser_edge = ser_edges_list.add_edges();			
-			ser_edge->set_from(static_cast<uint32_t>(edge.from));
-			ser_edge->set_to(static_cast<uint32_t>(edge.to));
+serialize::LandmarkTable Serialization::SerializeLandmarks(const graph::LandmarkTable<double>& landmarks) {
+	serialize::LandmarkTable ser_landmarks;
+	ser_landmarks.set_vertex_count(static_cast<uint32_t>(landmarks.vertex_count));
+	for (graph::VertexId landmark : landmarks.landmarks) {
+		ser_landmarks.add_landmarks(static_cast<uint32_t>(landmark));
+	}
+	ser_landmarks.mutable_from_landmarks()->Add(landmarks.from_landmarks.begin(), landmarks.from_landmarks.end());
+	ser_landmarks.mutable_to_landmarks()->Add(landmarks.to_landmarks.begin(), landmarks.to_landmarks.end());
+	return ser_landmarks;
+}
 
-			//        id,        
-			size_t from_name_id = catalog_.StopFind(edge.fromName)->id;
-			ser_edge->set_from_name_id(static_cast<uint32_t>(from_name_id));
+serialize::ComponentIndex Serialization::SerializeComponents(const graph::ComponentIndex& components) {
+	serialize::ComponentIndex ser_components;
+	ser_components.mutable_components()->Add(components.components.begin(), components.components.end());
+	ser_components.set_component_count(static_cast<uint32_t>(components.component_count));
+	ser_components.mutable_reachable()->Add(components.reachable.begin(), components.reachable.end());
+	ser_components.mutable_rows()->Add(components.rows.begin(), components.rows.end());
+	ser_components.set_row_count(static_cast<uint32_t>(components.row_count));
+	return ser_components;
+}
 
-			//        id,        
-			size_t to_name_id = catalog_.StopFind(edge.toName)->id;
-			ser_edge->set_to_name_id(static_cast<uint32_t>(to_name_id));
+template <typename StoredWeight>
+serialize::RoutesInternalData Serialization::SerializeRoutes(const graph::RoutesTable<StoredWeight>& routes) {
+	serialize::RoutesInternalData ser_routes;
+	ser_routes.set_vertex_count(static_cast<uint32_t>(routes.vertex_count));
+	//    :   -  ,   -  id
+	if constexpr (std::is_same_v<StoredWeight, float>) {
+		ser_routes.mutable_float_weights()->Add(routes.weights.begin(), routes.weights.end());
+	}else if constexpr (std::is_same_v<StoredWeight, graph::FixedWeight>) {
+		for (graph::FixedWeight weight : routes.weights) {
+			ser_routes.add_fixed_weights(weight.ticks);
+		}
+	}else {
+		ser_routes.mutable_weights()->Add(routes.weights.begin(), routes.weights.end());
+	}
+	ser_routes.mutable_prev_edges()->Add(routes.prev_edges.begin(), routes.prev_edges.end());
+	return ser_routes;
+}
 
-			//      ,     ,    -   
-			size_t route_name_id = from_name_id;
-			if (edge.type == "Bus"){
-				route_name_id = catalog_.BusFind(edge.name)->id;
-			}
-			ser_edge->set_route_name_id(static_cast<uint32_t>(route_name_id));
+serialize::Graph Serialization::SerializeGraph(const graph::DirectedWeightedGraph<double>& graph) {
+	serialize::Graph ser_graph;
+	size_t graphSize = graph.GetVertexCount();
+	serialize::EdgeList ser_edges_list;
 
-			ser_edge->set_route_type(edge.type);
-			ser_edge->set_weight(edge.weight);
-			ser_edge->set_stop_count(edge.stopCount);
-		}
+	//     id,    id        
+	for (graph::EdgeId edgeId = 0; edgeId < graph.GetEdgeCount(); ++edgeId) {
+		const graph::Edge<double>& edge = graph.GetEdge(edgeId);
+		serialize::Edge* ser_edge = ser_edges_list.add_edges();
+		ser_edge->set_from(static_cast<uint32_t>(edge.from));
+		ser_edge->set_to(static_cast<uint32_t>(edge.to));
+		//         id
+		ser_edge->set_item_id(edge.itemId);
+		ser_edge->set_type(static_cast<serialize::EdgeType>(edge.type));
+		ser_edge->set_weight(edge.weight);
+		ser_edge->set_stop_count(edge.stopCount);
 	}	
 	ser_graph.set_vertex_count(static_cast<uint32_t>(graphSize));
 	*ser_graph.mutable_edges() = std::move(ser_edges_list);
@@ -194,32 +275,120 @@ void Serialization::DeserializeRouter(serialize::TransportRouter srouter) {
 		settings[key] = value;
 	}
 
-	route_.SetSettings(std::move(settings));
-	route_.SetGraph(DeserializeGraph(std::move(*srouter.mutable_graph())));
+	transport::route::RoutingOptions options;
+	if (srouter.options().engine_given()) {
+		options.engine = static_cast<transport::route::RoutingEngine>(srouter.options().engine());
+	}
+	options.graphModel = static_cast<transport::route::GraphModel>(srouter.options().graph_model());
+	options.weightFormat = static_cast<transport::route::WeightFormat>(srouter.options().weight_format());
+	options.tableWeight = static_cast<transport::route::TableWeight>(srouter.options().table_weight());
+
+	route_.SetSettings(std::move(settings), options);
+
+	std::vector<transport::geo::Coordinates> coordinates(catalog_.GetUniqueStopCount());
+	for (const transport::domain::Stop& stop : catalog_.GetStopStorage()) {
+		coordinates[stop.id] = stop.coord;
+	}
+	route_.SetStopCoordinates(std::move(coordinates));
+
+	if (srouter.has_landmarks()) {
+		route_.SetGraph(DeserializeGraph(std::move(*srouter.mutable_graph())), DeserializeLandmarks(srouter.landmarks()));
+	}else if (srouter.has_hub_labels()) {
+		graph::HubLabels<double>::Labels labels{ DeserializeHubLabelSet(srouter.hub_labels().forward()),
+			DeserializeHubLabelSet(srouter.hub_labels().backward()) };
+		route_.SetGraph(DeserializeGraph(std::move(*srouter.mutable_graph())), DeserializeHierarchy(srouter.hierarchy()), std::move(labels));
+	}else if (srouter.has_hierarchy()) {
+		route_.SetGraph(DeserializeGraph(std::move(*srouter.mutable_graph())), DeserializeHierarchy(srouter.hierarchy()));
+	}else if (!srouter.has_routes()) {
+		route_.SetGraph(DeserializeGraph(std::move(*srouter.mutable_graph())));
+	}else if (srouter.routes().float_weights_size() > 0) {
+		route_.SetGraph(DeserializeGraph(std::move(*srouter.mutable_graph())), DeserializeRoutes<float>(srouter.routes()));
+	}else if (srouter.routes().fixed_weights_size() > 0) {
+		route_.SetGraph(DeserializeGraph(std::move(*srouter.mutable_graph())), DeserializeRoutes<graph::FixedWeight>(srouter.routes()));
+	}else {
+		route_.SetGraph(DeserializeGraph(std::move(*srouter.mutable_graph())), DeserializeRoutes<double>(srouter.routes()));
+	}
+	//       ,     
+	route_.SetComponentIndex(DeserializeComponents(srouter.components()));
+}
+
+template <typename StoredWeight>
+graph::RoutesTable<StoredWeight> Serialization::DeserializeRoutes(const serialize::RoutesInternalData& ser_routes) {
+	graph::RoutesTable<StoredWeight> routes;
+	routes.vertex_count = ser_routes.vertex_count();
+	if constexpr (std::is_same_v<StoredWeight, float>) {
+		routes.weights.assign(ser_routes.float_weights().begin(), ser_routes.float_weights().end());
+	}else if constexpr (std::is_same_v<StoredWeight, graph::FixedWeight>) {
+		routes.weights.reserve(ser_routes.fixed_weights_size());
+		for (uint32_t ticks : ser_routes.fixed_weights()) {
+			routes.weights.push_back(graph::FixedWeight::FromTicks(ticks));
+		}
+	}else {
+		routes.weights.assign(ser_routes.weights().begin(), ser_routes.weights().end());
+	}
+	routes.prev_edges.assign(ser_routes.prev_edges().begin(), ser_routes.prev_edges().end());
+	return routes;
+}
+
+graph::ContractionHierarchy<double>::Hierarchy Serialization::DeserializeHierarchy(const serialize::ContractionHierarchy& ser_hierarchy) {
+	graph::ContractionHierarchy<double>::Hierarchy hierarchy;
+	hierarchy.ranks.assign(ser_hierarchy.ranks().begin(), ser_hierarchy.ranks().end());
+	hierarchy.shortcuts.reserve(ser_hierarchy.shortcut_from_size());
+	for (int i = 0; i < ser_hierarchy.shortcut_from_size(); ++i) {
+		hierarchy.shortcuts.push_back({ ser_hierarchy.shortcut_from(i), ser_hierarchy.shortcut_to(i), ser_hierarchy.shortcut_weight(i),
+			ser_hierarchy.shortcut_first(i), ser_hierarchy.shortcut_second(i) });
+	}
+	return hierarchy;
+}
+
+graph::HubLabels<double>::LabelSet Serialization::DeserializeHubLabelSet(const serialize::HubLabelSet& ser_labels) {
+	graph::HubLabels<double>::LabelSet labels;
+	labels.offsets.assign(ser_labels.offsets().begin(), ser_labels.offsets().end());
+	labels.entries.reserve(ser_labels.hubs_size());
+	for (int i = 0; i < ser_labels.hubs_size(); ++i) {
+		labels.entries.push_back({ ser_labels.hubs(i), ser_labels.weights(i), ser_labels.arcs(i) });
+	}
+	return labels;
+}
+
+graph::LandmarkTable<double> Serialization::DeserializeLandmarks(const serialize::LandmarkTable& ser_landmarks) {
+	graph::LandmarkTable<double> landmarks;
+	landmarks.vertex_count = ser_landmarks.vertex_count();
+	landmarks.landmarks.assign(ser_landmarks.landmarks().begin(), ser_landmarks.landmarks().end());
+	landmarks.from_landmarks.assign(ser_landmarks.from_landmarks().begin(), ser_landmarks.from_landmarks().end());
+	landmarks.to_landmarks.assign(ser_landmarks.to_landmarks().begin(), ser_landmarks.to_landmarks().end());
+	return landmarks;
+}
+
+graph::ComponentIndex Serialization::DeserializeComponents(const serialize::ComponentIndex& ser_components) {
+	graph::ComponentIndex components;
+	components.components.assign(ser_components.components().begin(), ser_components.components().end());
+	components.component_count = ser_components.component_count();
+	components.reachable.assign(ser_components.reachable().begin(), ser_components.reachable().end());
+	components.rows.assign(ser_components.rows().begin(), ser_components.rows().end());
+	components.row_count = ser_components.row_count();
+	return components;
 }
 
 graph::DirectedWeightedGraph<double> Serialization::DeserializeGraph(serialize::Graph&& graph) {
 	graph::DirectedWeightedGraph<double> result_graph(graph.vertex_count());
 	for (const auto& ser_edge : *graph.mutable_edges()->mutable_edges()) {
+		//     (  id)  :      
+		if (!ser_edge.GetReflection()->GetUnknownFields(ser_edge).empty()) {
+			throw std::runtime_error("Base graph has an outdated edge format, rebuild it with make_base");
+		}
 		graph::Edge<double> edge;
 		edge.from = ser_edge.from();
 		edge.to = ser_edge.to();
-		edge.fromName = stopIt[ser_edge.from_name_id()]->name;
-		edge.toName = stopIt[ser_edge.to_name_id()]->name;
-		edge.type = ser_edge.route_type();
-
-		if (edge.type == "Bus") {
-			edge.name = busIt[ser_edge.route_name_id()]->name;
-		}else {
-			edge.name = stopIt[ser_edge.route_name_id()]->name;
-		}
-
+		edge.type = static_cast<graph::EdgeType>(ser_edge.type());
+		edge.itemId = ser_edge.item_id();
 		edge.weight = ser_edge.weight();
 		edge.stopCount = ser_edge.stop_count();
 
 		result_graph.AddEdge(edge);
 	}
 
+	result_graph.Freeze();
 	return result_graph;
 }
 
@@ -0,0 +1,103 @@
+#include "headers/thread_pool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace parallel {
+    ThreadPool::ThreadPool(size_t thread_count) {
+        if (thread_count == 0) {
+            thread_count = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+        }
+        for (size_t i = 1; i < thread_count; ++i) {
+            workers_.emplace_back([this]() { Work(); });
+        }
+    }
+
+    ThreadPool::~ThreadPool() {
+        {
+            std::lock_guard lock(mutex_);
+            stop_ = true;
+        }
+        start_.notify_all();
+        for (std::thread& worker : workers_) {
+            worker.join();
+        }
+    }
+
+    size_t ThreadPool::GetThreadCount() const {
+        return workers_.size() + 1;
+    }
+
+    void ThreadPool::ParallelFor(size_t count, const std::function<void(size_t)>& task) {
+        if (workers_.empty() || count <= 1) {
+            for (size_t i = 0; i < count; ++i) {
+                task(i);
+            }
+            return;
+        }
+
+        // Вызовы из разных потоков выполняются по очереди: у пула одно текущее задание
+        std::lock_guard call(callMutex_);
+        {
+            std::lock_guard lock(mutex_);
+            task_ = &task;
+            taskCount_ = count;
+            nextTask_ = 0;
+            activeWorkers_ = workers_.size();
+            ++generation_;
+        }
+        start_.notify_all();
+        RunTasks();
+
+        // Ждем рабочих и после исключения: они обращаются к task, пока не закончат
+        std::unique_lock lock(mutex_);
+        finish_.wait(lock, [this]() { return activeWorkers_ == 0; });
+        task_ = nullptr;
+        if (error_) {
+            std::exception_ptr error = std::move(error_);
+            error_ = nullptr;
+            std::rethrow_exception(error);
+        }
+    }
+
+    void ThreadPool::Work() {
+        size_t seenGeneration = 0;
+        while (true) {
+            std::unique_lock lock(mutex_);
+            start_.wait(lock, [this, seenGeneration]() { return stop_ || generation_ != seenGeneration; });
+            if (stop_) {
+                return;
+            }
+            seenGeneration = generation_;
+            lock.unlock();
+
+            RunTasks();
+
+            lock.lock();
+            if (--activeWorkers_ == 0) {
+                finish_.notify_all();
+            }
+        }
+    }
+
+    void ThreadPool::RunTasks() {
+        for (size_t index = nextTask_++; index < taskCount_; index = nextTask_++) {
+            try {
+                (*task_)(index);
+            }catch (...) {
+                // Запоминаем первое исключение, оставшиеся задачи не запускаются
+                std::lock_guard lock(mutex_);
+                if (!error_) {
+                    error_ = std::current_exception();
+                }
+                nextTask_ = taskCount_;
+            }
+        }
+    }
+}
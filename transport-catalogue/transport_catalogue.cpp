@@ -6,137 +6,332 @@
 #include <deque>
 #include <unordered_map>
 #include <algorithm>
+#include <unordered_set>
+#include <stdexcept>
+#include <string>
 
 namespace transport {
 namespace catalog {
+	namespace {
+		uint64_t SegmentKey(uint32_t from, uint32_t to) {
+			uint64_t low = std::min(from, to);
+			uint64_t high = std::max(from, to);
+			return (low << 32) | high;
+		}
+
+		//Вызывает segment(from, to) для каждой пары соседних остановок маршрута; обратный путь некольцевого маршрута
+		//проходит те же пары в другую сторону, его обработка - на вызывающей стороне
+		template <typename Segment>
+		void ForEachSegment(domain::StopIds stops, Segment segment) {
+			for (size_t i = 1; i < stops.size(); ++i) {
+				segment(stops[i - 1], stops[i]);
+			}
+		}
+	}
+
 	TransportCatalogue::TransportCatalogue() {}
 
 	void TransportCatalogue::AddStop(std::string_view stopName, geo::Coordinates coordinates) {
-		size_t stopId = stopStorage.size();
-		stopStorage.push_back(domain::Stop{std::string(stopName), coordinates, stopId });
-		stops[stopStorage.back().name] = &stopStorage.back();
+		uint32_t stopId = stops.Add(stopName, nameArena);
+		stopStorage.push_back(domain::Stop{ stops.GetName(stopId), coordinates, stopId });
 		++uniqueStopCount;
+		routeIndexReady = false;
 	}
 
 	void TransportCatalogue::AddRoute(std::string_view routeName, std::deque<std::string_view> stopsName, bool loope) {
-		std::deque<const domain::Stop*> newStops;
-		for (auto it = stopsName.begin(); it != stopsName.end(); ++it) {
-			newStops.push_back(StopFind(*it));
+		AddRoute(routeName, FindStopIds(stopsName), loope);
+	}
+
+	void TransportCatalogue::AddRoute(std::string_view routeName, const std::vector<uint32_t>& stopIds, bool loope) {
+		uint32_t busId = routes.Add(routeName, nameArena);
+		uint32_t firstStop = static_cast<uint32_t>(routeStops.size());
+		routeStops.insert(routeStops.end(), stopIds.begin(), stopIds.end());
+		routesStopCount += stopIds.size();
+		busStorage.push_back(domain::Bus{ routes.GetName(busId), firstStop, static_cast<uint32_t>(stopIds.size()), loope, busId });
+		routeIndexReady = false;
+		routeStats.emplace_back();
+		AddRouteStats(busStorage.back());
+	}
+
+	void TransportCatalogue::UpdateRoute(std::string_view routeName, std::deque<std::string_view> stopsName, bool loope) {
+		uint32_t busId = routes.Find(routeName);
+		if (busId == NameTable::NO_ID) {
+			AddRoute(routeName, std::move(stopsName), loope);
+			return;
+		}
+		std::vector<uint32_t> stopIds = FindStopIds(stopsName);
+		domain::Bus& bus = busStorage[busId];
+		routesStopCount = routesStopCount - bus.stopCount + stopIds.size();
+		RemoveRouteStats(bus);
+		//Новый список дописывается в конец общего массива, старый остается там до Freeze
+		staleRouteStops += bus.stopCount;
+		bus.firstStop = static_cast<uint32_t>(routeStops.size());
+		bus.stopCount = static_cast<uint32_t>(stopIds.size());
+		routeStops.insert(routeStops.end(), stopIds.begin(), stopIds.end());
+		bus.loope = loope;
+		routeIndexReady = false;
+		AddRouteStats(bus);
+	}
+
+	std::vector<uint32_t> TransportCatalogue::FindStopIds(const std::deque<std::string_view>& stopsName)const {
+		std::vector<uint32_t> result;
+		result.reserve(stopsName.size());
+		for (std::string_view name : stopsName) {
+			uint32_t stopId = stops.Find(name);
+			if (stopId == NameTable::NO_ID) {
+				throw std::out_of_range("Unknown stop " + std::string(name));
+			}
+			result.push_back(stopId);
+		}
+		return result;
+	}
+
+	void TransportCatalogue::Freeze() {
+		if (staleRouteStops > 0) {
+			std::vector<uint32_t> compacted;
+			compacted.reserve(routeStops.size() - staleRouteStops);
+			for (domain::Bus& bus : busStorage) {
+				domain::StopIds busStops = GetBusStops(bus);
+				bus.firstStop = static_cast<uint32_t>(compacted.size());
+				compacted.insert(compacted.end(), busStops.begin(), busStops.end());
+			}
+			routeStops = std::move(compacted);
+			staleRouteStops = 0;
 		}
-		size_t BusId = busStorage.size();
-		routesStopCount += newStops.size();
-		busStorage.push_back(domain::Bus{ std::string(routeName) , std::move(newStops), loope, BusId});
-		routes[busStorage.back().name] = &busStorage.back();
+		routeStops.shrink_to_fit();
+		stopStorage.shrink_to_fit();
+		busStorage.shrink_to_fit();
+		routeIndexReady = false;
+	}
+
+	void TransportCatalogue::AddRouteStats(const domain::Bus& bus) {
+		RouteStats& stats = routeStats[bus.id];
+		stats = RouteStats{};
+		domain::StopIds busStops = GetBusStops(bus);
+		if (busStops.empty()) {
+			return;
+		}
+		stats.stops = bus.loope ? busStops.size() : busStops.size() * 2 - 1;
+		std::unordered_set<uint32_t> uniqueStops(busStops.begin(), busStops.end());
+		stats.uniqueStops = uniqueStops.size();
+
+		std::unordered_map<uint64_t, SegmentUse> uses;
+		auto addLength = [&stats](double length, double geoLength) {
+			stats.geoLength += geoLength;
+			if (length == 0) {
+				stats.fallbackLength += geoLength;
+			}else {
+				stats.roadLength += length;
+			}
+		};
+		ForEachSegment(busStops, [&](uint32_t from, uint32_t to) {
+			//Расстояние по прямой одинаково в обе стороны, считается один раз на пару
+			double geoLength = geo::ComputeDistance(stopStorage[from].coord, stopStorage[to].coord);
+			SegmentUse& use = uses[SegmentKey(from, to)];
+			use.busId = bus.id;
+			addLength(GetDistance(from, to), geoLength);
+			++(from <= to ? use.forward : use.backward);
+			if (!bus.loope) {
+				addLength(GetDistance(to, from), geoLength);
+				++(to <= from ? use.forward : use.backward);
+			}
+		});
+		for (const auto& [key, use] : uses) {
+			segmentBuses[key].push_back(use);
+		}
+	}
+
+	void TransportCatalogue::RemoveRouteStats(const domain::Bus& bus) {
+		uint32_t busId = bus.id;
+		ForEachSegment(GetBusStops(bus), [&](uint32_t from, uint32_t to) {
+			auto usesIt = segmentBuses.find(SegmentKey(from, to));
+			if (usesIt == segmentBuses.end()) {
+				return;
+			}
+			std::vector<SegmentUse>& uses = usesIt->second;
+			uses.erase(std::remove_if(uses.begin(), uses.end(), [busId](const SegmentUse& use) {
+				return use.busId == busId;
+			}), uses.end());
+			if (uses.empty()) {
+				segmentBuses.erase(usesIt);
+			}
+		});
+		routeStats[bus.id] = RouteStats{};
 	}
 
 	void TransportCatalogue::SetDistance(std::string_view stopFrom, std::string_view stopTo, int distance) {
-		if (stops.find(stopFrom) != stops.end() && stops.find(stopTo) != stops.end()) {
-			distanceBwStops[{stops.at(stopFrom), stops.at(stopTo)}] = distance;
+		uint32_t fromId = stops.Find(stopFrom);
+		uint32_t toId = stops.Find(stopTo);
+		if (fromId != NameTable::NO_ID && toId != NameTable::NO_ID) {
+			SetDistance(fromId, toId, distance);
 		}
 	}
 
-	const std::deque<domain::Stop>& TransportCatalogue::GetStopStorage() {
+	void TransportCatalogue::SetDistance(uint32_t from, uint32_t to, int distance) {
+		//Расстояние в одну сторону служит и обратным, пока обратное не задано, поэтому меняться могут оба направления перегона
+		double oldForward = GetDistance(from, to);
+		double oldBackward = GetDistance(to, from);
+		distanceBwStops.Set(from, to, distance);
+		double newForward = GetDistance(from, to);
+		double newBackward = GetDistance(to, from);
+		auto usesIt = segmentBuses.find(SegmentKey(from, to));
+		if (usesIt == segmentBuses.end() || (oldForward == newForward && oldBackward == newBackward)) {
+			return;
+		}
+
+		auto applyLength = [](RouteStats& stats, uint32_t count, double oldLength, double newLength, double geoLength) {
+			if (count == 0 || oldLength == newLength) {
+				return;
+			}
+			if (oldLength == 0) {
+				stats.fallbackLength -= count * geoLength;
+			}else {
+				stats.roadLength -= count * oldLength;
+			}
+			if (newLength == 0) {
+				stats.fallbackLength += count * geoLength;
+			}else {
+				stats.roadLength += count * newLength;
+			}
+		};
+		double geoLength = geo::ComputeDistance(stopStorage[from].coord, stopStorage[to].coord);
+		bool ascending = from <= to;
+		for (const SegmentUse& use : usesIt->second) {
+			RouteStats& stats = routeStats[use.busId];
+			applyLength(stats, ascending ? use.forward : use.backward, oldForward, newForward, geoLength);
+			applyLength(stats, ascending ? use.backward : use.forward, oldBackward, newBackward, geoLength);
+		}
+	}
+
+	void TransportCatalogue::ReserveDistances(size_t count) {
+		distanceBwStops.Reserve(count);
+	}
+
+	const std::vector<domain::Stop>& TransportCatalogue::GetStopStorage()const {
 		return stopStorage;
 	}
 
-	const std::deque<domain::Bus>& TransportCatalogue::GetBusStorage() {
+	const std::vector<domain::Bus>& TransportCatalogue::GetBusStorage()const {
 		return busStorage;
 	}
 
-	const std::unordered_map<std::pair<const domain::Stop*, const domain::Stop*>, int, domain::StopLengthHasher>& TransportCatalogue::GetAllDistance() {
+	domain::StopIds TransportCatalogue::GetBusStops(const domain::Bus& bus)const {
+		return { routeStops.data() + bus.firstStop, bus.stopCount };
+	}
+
+	const DistanceTable& TransportCatalogue::GetAllDistance()const {
 		return distanceBwStops;
 	}
 
 	const domain::Bus* TransportCatalogue::BusFind(std::string_view busName)const {
-		return routes.at(busName);
+		uint32_t busId = routes.Find(busName);
+		if (busId == NameTable::NO_ID) {
+			throw std::out_of_range("Unknown bus " + std::string(busName));
+		}
+		return &busStorage[busId];
 	}
 
 	const domain::Stop* TransportCatalogue::StopFind(std::string_view stopName)const {
-		return stops.at(stopName);
+		uint32_t stopId = stops.Find(stopName);
+		if (stopId == NameTable::NO_ID) {
+			throw std::out_of_range("Unknown stop " + std::string(stopName));
+		}
+		return &stopStorage[stopId];
 	}
 
-	const domain::Route TransportCatalogue::GetRoute(std::string_view busName) {
-		try {
-			const domain::Bus* busInfo = BusFind(busName);
-			domain::Route result;
-			result.name = busInfo->name;
-			result.stops = busInfo->stops.size();
-			result.length = 0;
-			result.curvature = 0;
-
-			for (auto it = busInfo->stops.begin(); it != busInfo->stops.end() - 1; ++it) {
-				double curvature = geo::ComputeDistance((*it)->coord, (*(it + 1))->coord);
-				double length = GetDistance(stops.at((*it)->name), stops.at((*(it + 1))->name));
-				result.length += length;
-				if (length == 0) {
-					result.length += curvature;
-				}
-				result.curvature += curvature;
-			}
+	bool TransportCatalogue::HasStop(std::string_view stopName)const {
+		return stops.Find(stopName) != NameTable::NO_ID;
+	}
 
-			if (!busInfo->loope) {
-				for (auto it = (busInfo->stops.end() - 1); it != busInfo->stops.begin(); --it) {
-					double curvature = geo::ComputeDistance((*it)->coord, (*(it - 1))->coord);
-					double length = GetDistance(stops.at((*it)->name), stops.at((*(it - 1))->name));
-					result.length += length;
-					if (length == 0) {
-						result.length += curvature;
-					}
-					result.curvature += curvature;
-				}
-				result.stops = busInfo->stops.size() * 2 - 1;
+	std::vector<uint32_t> TransportCatalogue::GetSegmentBuses(uint32_t stopFrom, uint32_t stopTo)const {
+		std::vector<uint32_t> result;
+		auto usesIt = segmentBuses.find(SegmentKey(stopFrom, stopTo));
+		if (usesIt != segmentBuses.end()) {
+			for (const SegmentUse& use : usesIt->second) {
+				result.push_back(use.busId);
 			}
+		}
+		return result;
+	}
 
-			std::deque<const domain::Stop*> st = busInfo->stops;
-			std::sort(st.begin(), st.end());
-			auto last = std::unique(st.begin(), st.end());
-			result.uStops = last - st.begin();
-			result.curvature = result.length / result.curvature;
-			return result;
-		}catch (...) {
+	const domain::Route TransportCatalogue::GetRoute(std::string_view busName) {
+		uint32_t busId = routes.Find(busName);
+		if (busId == NameTable::NO_ID || busStorage[busId].stopCount == 0) {
 			return { busName, 0, 0, 0, 0 };
-		}			
+		}
+		const domain::Bus& busInfo = busStorage[busId];
+		const RouteStats& stats = routeStats[busInfo.id];
+		double length = stats.roadLength + stats.fallbackLength;
+		return { busInfo.name, stats.stops, stats.uniqueStops, length, length / stats.geoLength };
 	}
 
 	const std::deque<std::string_view> TransportCatalogue::GetStopBuses(std::string_view stopName) {
 		std::deque<std::string_view> result;
-		for (auto& [busname, busInfo] : routes) {
-			auto findRes = std::find_if(busInfo->stops.begin(), busInfo->stops.end(), [stopName](const domain::Stop* stop) {
-				return stop->name == stopName;
-			});
-			if (findRes != busInfo->stops.end()) {
-				result.push_back(busname);
-			}
+		uint32_t stopId = stops.Find(stopName);
+		if (stopId == NameTable::NO_ID) {
+			return result;
+		}
+		BuildRouteIndex();
+		for (uint32_t i = stopBusOffsets[stopId]; i < stopBusOffsets[stopId + 1]; ++i) {
+			result.push_back(busStorage[stopBusIds[i]].name);
 		}
-		std::sort(result.begin(), result.end());
 		return result;
 	}
 
-	double TransportCatalogue::GetDistance(const domain::Stop* stopFrom, const domain::Stop* stopTo) {
-		if (distanceBwStops.find({stopFrom, stopTo}) != distanceBwStops.end()) {
-			return distanceBwStops.at({stopFrom, stopTo});
-		}
+	double TransportCatalogue::GetDistance(uint32_t stopFrom, uint32_t stopTo)const {
+		return distanceBwStops.Get(stopFrom, stopTo);
+	}
 
-		if (distanceBwStops.find({stopTo, stopFrom}) != distanceBwStops.end()) {
-			return distanceBwStops.at({stopTo, stopFrom});
-		}
-		return 0;
+	const std::deque<const domain::Bus*>& TransportCatalogue::GetAllRoutes() {
+		BuildRouteIndex();
+		return sortedRoutes;
 	}
 
-	std::deque<const domain::Bus*> TransportCatalogue::GetAllRoutes() {
-		std::deque<const domain::Bus*> result;
-		for (const auto& [name, bus] : routes) {
-			if (bus->stops.size() > 0) {
-				result.push_back(bus);
-			}
+	void TransportCatalogue::BuildRouteIndex() {
+		if (routeIndexReady) {
+			return;
 		}
-		std::sort(result.begin(), result.end(), [](const domain::Bus* lhs, const domain::Bus* rhs) {
+		sortedRoutes.clear();
+		routes.ForEachFound([this](uint32_t busId) {
+			if (busStorage[busId].stopCount > 0) {
+				sortedRoutes.push_back(&busStorage[busId]);
+			}
+		});
+		std::sort(sortedRoutes.begin(), sortedRoutes.end(), [](const domain::Bus* lhs, const domain::Bus* rhs) {
 			return lhs->name < rhs->name;
 		});
-		return result;
+
+		//Маршруты обходятся по имени, поэтому список каждой остановки получается уже отсортированным.
+		//Маршрут, проходящий остановку несколько раз, попадает в ее список один раз
+		static constexpr uint32_t NO_BUS = UINT32_MAX;
+		std::vector<uint32_t> lastBus(stopStorage.size(), NO_BUS);
+		stopBusOffsets.assign(stopStorage.size() + 1, 0);
+		for (const domain::Bus* bus : sortedRoutes) {
+			for (uint32_t stop : GetBusStops(*bus)) {
+				if (lastBus[stop] != bus->id) {
+					lastBus[stop] = bus->id;
+					++stopBusOffsets[stop + 1];
+				}
+			}
+		}
+		for (size_t i = 1; i < stopBusOffsets.size(); ++i) {
+			stopBusOffsets[i] += stopBusOffsets[i - 1];
+		}
+		stopBusIds.assign(stopBusOffsets.back(), 0);
+		std::vector<uint32_t> nextSlot(stopBusOffsets.begin(), stopBusOffsets.end() - 1);
+		lastBus.assign(stopStorage.size(), NO_BUS);
+		for (const domain::Bus* bus : sortedRoutes) {
+			for (uint32_t stop : GetBusStops(*bus)) {
+				if (lastBus[stop] != bus->id) {
+					lastBus[stop] = bus->id;
+					stopBusIds[nextSlot[stop]++] = bus->id;
+				}
+			}
+		}
+		routeIndexReady = true;
 	}
 
-	size_t TransportCatalogue::GetUniqueStopCount() {
+	size_t TransportCatalogue::GetUniqueStopCount()const {
 		return uniqueStopCount;
 	}
 }
@@ -10,92 +10,678 @@
 #include <algorithm>
 #include <string_view>
 #include <memory>
+#include <iterator>
+#include <limits>
+#include <array>
+#include <cmath>
+#include <stdexcept>
 
 namespace transport {
 namespace route {
-	void Router::SetSettings(std::unordered_map<std::string, double>&& settings) {
+	namespace {
+		uint64_t VertexPairKey(const graph::Edge<double>& edge) {
+			return (static_cast<uint64_t>(edge.from) << 32) | static_cast<uint64_t>(edge.to);
+		}
+	}
+
+	RoutingEngine ParseRoutingEngine(std::string_view name) {
+		if (name == "all_pairs") {
+			return RoutingEngine::ALL_PAIRS;
+		}
+		if (name == "dijkstra") {
+			return RoutingEngine::DIJKSTRA;
+		}
+		if (name == "contraction_hierarchies") {
+			return RoutingEngine::CONTRACTION_HIERARCHIES;
+		}
+		if (name == "hub_labels") {
+			return RoutingEngine::HUB_LABELS;
+		}
+		if (name == "a_star") {
+			return RoutingEngine::A_STAR;
+		}
+		if (name == "raptor") {
+			return RoutingEngine::RAPTOR;
+		}
+		if (name == "auto") {
+			return RoutingEngine::AUTO;
+		}
+		throw std::invalid_argument("Unknown routing_engine: " + std::string(name));
+	}
+
+	GraphModel ParseGraphModel(std::string_view name) {
+		if (name == "linear") {
+			return GraphModel::LINEAR;
+		}
+		if (name == "folded") {
+			return GraphModel::FOLDED;
+		}
+		if (name == "stop_pairs") {
+			return GraphModel::STOP_PAIRS;
+		}
+		throw std::invalid_argument("Unknown routing_graph: " + std::string(name));
+	}
+
+	WeightFormat ParseWeightFormat(std::string_view name) {
+		if (name == "fixed") {
+			return WeightFormat::FIXED;
+		}
+		if (name == "floating") {
+			return WeightFormat::FLOATING;
+		}
+		throw std::invalid_argument("Unknown routing_weights: " + std::string(name));
+	}
+
+	TableWeight ParseTableWeight(std::string_view name) {
+		if (name == "float") {
+			return TableWeight::FLOAT;
+		}
+		if (name == "double") {
+			return TableWeight::DOUBLE;
+		}
+		throw std::invalid_argument("Unknown routing_table_weight: " + std::string(name));
+	}
+
+	void Router::SetLoader(std::function<void()> loader) {
+		loader_ = std::move(loader);
+	}
+
+	void Router::EnsureLoaded() {
+		std::call_once(loaded_, [this]() {
+			if (loader_) {
+				loader_();
+				loader_ = nullptr;
+			}
+		});
+	}
+
+	void Router::SetSettings(std::unordered_map<std::string, double>&& settings, const RoutingOptions& options) {
 		settings_ = std::move(settings);
+		options_ = options;
+		pool_.reset();
+	}
+
+	parallel::ThreadPool& Router::GetThreadPool() {
+		std::lock_guard lock(poolMutex_);
+		if (!pool_) {
+			auto threads = settings_.find("routing_threads");
+			pool_ = std::make_unique<parallel::ThreadPool>(threads != settings_.end() ? static_cast<size_t>(threads->second) : 0);
+		}
+		return *pool_;
+	}
+
+	double Router::GetSetting(const std::string& name)const {
+		auto setting = settings_.find(name);
+		return setting != settings_.end() ? setting->second : 0;
+	}
+
+	void Router::SetStopCoordinates(std::vector<geo::Coordinates>&& coordinates) {
+		stopCoordinates_ = std::move(coordinates);
 	}
 
 	void Router::SetGraph(graph::DirectedWeightedGraph<double>&& graph_) {
 		graph = std::move(graph_);
-		routerFinder = std::make_unique<graph::Router<double>>(graph);
+		CreateRouterFinder();
+	}
+
+	void Router::SetGraph(graph::DirectedWeightedGraph<double>&& graph_, graph::ContractionHierarchy<double>::Hierarchy&& hierarchy) {
+		graph = std::move(graph_);
+		routerFinder = std::make_unique<graph::ContractionHierarchy<double>>(graph, std::move(hierarchy));
+	}
+
+	void Router::SetGraph(graph::DirectedWeightedGraph<double>&& graph_, graph::ContractionHierarchy<double>::Hierarchy&& hierarchy,
+		graph::HubLabels<double>::Labels&& labels) {
+		graph = std::move(graph_);
+		routerFinder = std::make_unique<graph::HubLabels<double>>(graph, std::move(hierarchy), std::move(labels));
+	}
+
+	void Router::SetGraph(graph::DirectedWeightedGraph<double>&& graph_, graph::LandmarkTable<double>&& landmarks) {
+		graph = std::move(graph_);
+		routerFinder = std::make_unique<graph::AStarRouter<double>>(graph, CreateGeoHeuristic(), std::move(landmarks));
+	}
+
+	void Router::SetComponentIndex(graph::ComponentIndex&& components) {
+		components_ = std::move(components);
+	}
+
+	const graph::ComponentIndex& Router::GetComponentIndex()const {
+		return components_;
+	}
+
+	void Router::CreateComponentIndex() {
+		components_ = graph::BuildComponentIndex(graph, stopCoordinates_.size());
+	}
+
+	size_t Router::GetPrunedEdgeCount()const {
+		return prunedEdgeCount_;
 	}
 
 	const std::unordered_map<std::string, double>& Router::GetSettings() {
+		EnsureLoaded();
 		return settings_;
 	}
 
+	const RoutingOptions& Router::GetRoutingOptions() {
+		EnsureLoaded();
+		return options_;
+	}
+
 	const graph::DirectedWeightedGraph<double>& Router::GetGraph() {
+		EnsureLoaded();
 		return graph;
 	}
 
-	void Router::CreateWaitEdge(graph::VertexId fromId, graph::VertexId toId, std::string_view name, double weight) {
+	const graph::ContractionHierarchy<double>* Router::GetContractionHierarchy()const {
+		return dynamic_cast<const graph::ContractionHierarchy<double>*>(routerFinder.get());
+	}
+
+	const graph::HubLabels<double>* Router::GetHubLabels()const {
+		return dynamic_cast<const graph::HubLabels<double>*>(routerFinder.get());
+	}
+
+	const graph::AStarRouter<double>* Router::GetAStarRouter()const {
+		return dynamic_cast<const graph::AStarRouter<double>*>(routerFinder.get());
+	}
+
+	GraphModel Router::GetGraphModel() {
+		return options_.graphModel;
+	}
+
+	RoutingEngine Router::SelectEngine() {
+		RoutingEngine engine = RoutingEngine::ALL_PAIRS;
+		if (options_.engine) {
+			engine = *options_.engine;
+		}else if (settings_.count("routing_memory_limit")) {
+			engine = RoutingEngine::AUTO;
+		}
+
+		if (engine == RoutingEngine::AUTO) {
+			//лимит памяти задается в мегабайтах, без лимита предрасчет всех маршрутов разрешен всегда
+			auto limit = settings_.find("routing_memory_limit");
+			size_t allPairsMemory = graph::Router<double>::EstimateMemory(graph.GetVertexCount());
+			if (IsFixedWeights()) {
+				allPairsMemory = graph::Router<double, graph::FixedWeight>::EstimateMemory(graph.GetVertexCount());
+			}else if (IsFloatRoutesTable()) {
+				allPairsMemory = graph::Router<double, float>::EstimateMemory(graph.GetVertexCount());
+			}
+			if (limit != settings_.end() && allPairsMemory > limit->second * 1024 * 1024) {
+				return RoutingEngine::DIJKSTRA;
+			}
+			return RoutingEngine::ALL_PAIRS;
+		}
+		return engine;
+	}
+
+	bool Router::IsFloatRoutesTable() {
+		return options_.tableWeight == TableWeight::FLOAT;
+	}
+
+	bool Router::IsFixedWeights() {
+		return options_.weightFormat == WeightFormat::FIXED;
+	}
+
+	void Router::CreateRouterFinder() {
+		RoutingEngine engine = SelectEngine();
+		//RAPTOR строит маршруты по справочнику, граф с Дейкстрой остается для матриц и изохрон
+		if ((engine == RoutingEngine::DIJKSTRA || engine == RoutingEngine::RAPTOR) && IsFixedWeights()) {
+			routerFinder = std::make_unique<graph::DijkstraRouter<double, graph::RadixHeap<graph::FixedWeight>>>(graph);
+			return;
+		}
+		if (engine == RoutingEngine::DIJKSTRA || engine == RoutingEngine::RAPTOR) {
+			routerFinder = std::make_unique<graph::DijkstraRouter<double>>(graph);
+			return;
+		}
+		if (engine == RoutingEngine::CONTRACTION_HIERARCHIES) {
+			routerFinder = std::make_unique<graph::ContractionHierarchy<double>>(graph);
+			return;
+		}
+		if (engine == RoutingEngine::HUB_LABELS) {
+			routerFinder = std::make_unique<graph::HubLabels<double>>(graph);
+			return;
+		}
+		if (engine == RoutingEngine::A_STAR) {
+			auto landmarks = settings_.find("routing_landmarks");
+			size_t landmarkCount = landmarks != settings_.end() ? static_cast<size_t>(landmarks->second) : 8;
+			routerFinder = std::make_unique<graph::AStarRouter<double>>(graph, CreateGeoHeuristic(), graph::BuildLandmarkTable(graph, landmarkCount));
+			return;
+		}
+
+		parallel::ThreadPool& pool = GetThreadPool();
+		if (IsFixedWeights()) {
+			routerFinder = std::make_unique<graph::Router<double, graph::FixedWeight>>(graph, pool);
+		}else if (IsFloatRoutesTable()) {
+			routerFinder = std::make_unique<graph::Router<double, float>>(graph, pool);
+		}else {
+			routerFinder = std::make_unique<graph::Router<double>>(graph, pool);
+		}
+	}
+
+	graph::AStarRouter<double>::Heuristic Router::CreateGeoHeuristic() {
+		size_t stopCount = stopCoordinates_.size();
+		if (stopCount == 0 || graph.GetVertexCount() < stopCount) {
+			return nullptr;
+		}
+		std::vector<uint32_t> vertexStops = GetVertexStops();
+
+		//Дорожное расстояние может быть меньше расстояния по прямой, поэтому скорость по прямой берем максимальную по всем ребрам.
+		//Тогда время по прямой до цели не больше времени любого пути к ней
+		double minTimePerMeter = std::numeric_limits<double>::infinity();
+		double minWaitTime = std::numeric_limits<double>::infinity();
+		for (graph::EdgeId edgeId = 0; edgeId < graph.GetEdgeCount(); ++edgeId) {
+			const graph::Edge<double>& edge = graph.GetEdge(edgeId);
+			if (edge.type == graph::EdgeType::WAIT) {
+				minWaitTime = std::min(minWaitTime, edge.weight);
+				continue;
+			}
+			double distance = geo::ComputeDistance(stopCoordinates_[vertexStops[edge.from]], stopCoordinates_[vertexStops[edge.to]]);
+			if (distance > 0) {
+				minTimePerMeter = std::min(minTimePerMeter, edge.weight / distance);
+			}
+		}
+		if (minTimePerMeter == std::numeric_limits<double>::infinity()) {
+			return nullptr;
+		}
+
+		if (minWaitTime == std::numeric_limits<double>::infinity()) {
+			minWaitTime = 0;
+		}
+
+		//Вместо дуги берем хорду: она не длиннее дуги и считается без тригонометрии
+		static const double dr = 3.1415926535 / 180.;
+		std::vector<std::array<double, 3>> points;
+		points.reserve(stopCount);
+		for (const geo::Coordinates& coord : stopCoordinates_) {
+			points.push_back({ cos(coord.lat * dr) * cos(coord.lng * dr), cos(coord.lat * dr) * sin(coord.lng * dr), sin(coord.lat * dr) });
+		}
+
+		//С остановки, отличной от целевой, не уехать без ожидания, запас в метр покрывает погрешность формулы расстояния
+		return [points = std::move(points), vertexStops = std::move(vertexStops), stopCount, minTimePerMeter, minWaitTime](graph::VertexId vertex, graph::VertexId target) {
+			const std::array<double, 3>& from = points[vertexStops[vertex]];
+			const std::array<double, 3>& to = points[vertexStops[target]];
+			if (&from == &to) {
+				return 0.0;
+			}
+			double chord = sqrt((from[0] - to[0]) * (from[0] - to[0]) + (from[1] - to[1]) * (from[1] - to[1]) + (from[2] - to[2]) * (from[2] - to[2]));
+			double waitTime = vertex < stopCount ? minWaitTime : 0.0;
+			return waitTime + std::max(chord * 6371000 - 1.0, 0.0) * minTimePerMeter;
+		};
+	}
+
+	std::vector<uint32_t> Router::GetVertexStops() {
+		//Вершины остановок идут первыми, остальные вершины берут остановку из входящего ребра ожидания
+		//или исходящего ребра высадки: у первой вершины цепочки поездки нет высадки, у последней - ожидания
+		size_t stopCount = stopCoordinates_.size();
+		std::vector<uint32_t> vertexStops(graph.GetVertexCount());
+		for (graph::VertexId vertex = 0; vertex < vertexStops.size(); ++vertex) {
+			vertexStops[vertex] = static_cast<uint32_t>(vertex % stopCount);
+		}
+		for (graph::EdgeId edgeId = 0; edgeId < graph.GetEdgeCount(); ++edgeId) {
+			const graph::Edge<double>& edge = graph.GetEdge(edgeId);
+			if (edge.type == graph::EdgeType::WAIT) {
+				vertexStops[edge.to] = edge.itemId;
+			}else if (edge.type == graph::EdgeType::ALIGHT) {
+				vertexStops[edge.from] = static_cast<uint32_t>(edge.to);
+			}
+		}
+		return vertexStops;
+	}
+
+	void Router::CreateWaitEdge(graph::VertexId fromId, graph::VertexId toId, double weight) {
 		auto edgeExist = graph.GetIncidentEdges(fromId);
 		if (edgeExist.begin() == edgeExist.end()) {
-			graph.AddEdge(graph::Edge<double> { fromId, toId, name, name, name, "Wait", weight });
+			graph.AddEdge(graph::Edge<double> { fromId, toId, weight, graph::EdgeType::WAIT, static_cast<uint32_t>(fromId) });
 		}
 	}
 
-	double Router::CalculateEdgeWeight(const transport::domain::Stop* from, const transport::domain::Stop* to, transport::catalog::TransportCatalogue& catalog) {
-		double transformSpeed = settings_["bus_velocity"] * 1000 / 60;
+	double Router::CalculateEdgeWeight(uint32_t from, uint32_t to, transport::catalog::TransportCatalogue& catalog) {
+		double transformSpeed = GetSetting("bus_velocity") * 1000 / 60;
 		auto distance = catalog.GetDistance(from, to);
 		return (distance / transformSpeed);
 	}
 
 	void Router::CreateRoutes(transport::catalog::TransportCatalogue& catalog) {
+		std::vector<geo::Coordinates> coordinates(catalog.GetUniqueStopCount());
+		for (const domain::Stop& stop : catalog.GetStopStorage()) {
+			coordinates[stop.id] = stop.coord;
+		}
+		SetStopCoordinates(std::move(coordinates));
+
+		if (GetGraphModel() == GraphModel::LINEAR) {
+			CreateLinearGraph(catalog);
+		}else {
+			CreateStopPairGraph(catalog);
+		}
+		graph.Freeze();
+		CreateComponentIndex();
+		CreateRouterFinder();
+	}
+
+	void Router::CreateStopPairGraph(transport::catalog::TransportCatalogue& catalog) {
 		size_t uniqueStopsCount = catalog.GetUniqueStopCount();
-		graph::DirectedWeightedGraph<double> result(uniqueStopsCount * 2);
+		bool folded = GetGraphModel() == GraphModel::FOLDED;
+		graph::DirectedWeightedGraph<double> result(folded ? uniqueStopsCount : uniqueStopsCount * 2);
 		graph = std::move(result);
-		std::deque<const domain::Bus*> allRoutes = catalog.GetAllRoutes();
+		const std::deque<const domain::Bus*>& allRoutes = catalog.GetAllRoutes();
 			
-		double waitTime = settings_["bus_wait_time"];
+		double waitTime = GetSetting("bus_wait_time");
 			
 		for (const domain::Bus* itemRoute : allRoutes) {
-			for (auto itemStopIt = itemRoute->stops.begin(); itemStopIt != itemRoute->stops.end() - 1; ++itemStopIt) {
-				double derectWeight = 0;
-				double backWeight = 0;
-				int stopCount = 0;
-				auto nextStopIt = itemStopIt + 1;
-				std::pair<const transport::domain::Stop*, const transport::domain::Stop*> stopPair{ *itemStopIt , *itemStopIt };
-				graph::VertexId departureVertextId = (**itemStopIt).id;
-				graph::VertexId waitVertextId = (**itemStopIt).id + uniqueStopsCount;
-
-				CreateWaitEdge(departureVertextId, waitVertextId, (**itemStopIt).name, waitTime);
-
-				while (nextStopIt != itemRoute->stops.end()) {
-					++stopCount;
-					stopPair.second = *nextStopIt;
-					graph::VertexId destinationVertexId = (**nextStopIt).id;
-					graph::VertexId innerWaitVertexId = (**nextStopIt).id + uniqueStopsCount;
-
-					CreateWaitEdge(destinationVertexId, innerWaitVertexId, (**nextStopIt).name, waitTime);
-
-					derectWeight += CalculateEdgeWeight(stopPair.first, stopPair.second, catalog);
-					graph.AddEdge(graph::Edge<double> { waitVertextId, destinationVertexId, (**itemStopIt).name, (**nextStopIt).name, itemRoute->name, "Bus", derectWeight, stopCount });
-						
-					if (!itemRoute->loope) {							
-						backWeight += CalculateEdgeWeight(stopPair.second, stopPair.first, catalog);
-						graph.AddEdge(graph::Edge<double> { innerWaitVertexId, departureVertextId, (**nextStopIt).name, (**itemStopIt).name, itemRoute->name, "Bus", backWeight, stopCount });
-					}						
-					stopPair.first = *nextStopIt;
-					++nextStopIt;
+			for (uint32_t stop : catalog.GetBusStops(*itemRoute)) {
+				if (!folded && itemRoute->stopCount > 1) {
+					CreateWaitEdge(stop, stop + uniqueStopsCount, waitTime);
+				}
+			}
+		}
+		std::vector<graph::Edge<double>> busEdges = CreateAllBusEdges(allRoutes, catalog);
+		prunedEdgeCount_ = PruneParallelEdges(busEdges);
+		for (const graph::Edge<double>& edge : busEdges) {
+			graph.AddEdge(edge);
+		}
+	}
+
+	size_t Router::PruneParallelEdges(std::vector<graph::Edge<double>>& edges) {
+		//Из вершины ожидания в остановку кратчайший путь может пройти только по самому дешевому из маршрутов между ними.
+		//При равных весах остается ребро, добавленное раньше, - его же выбрал бы поиск по полному графу
+		std::unordered_map<uint64_t, size_t> pairEdges;
+		pairEdges.reserve(edges.size());
+		size_t keptCount = 0;
+		for (const graph::Edge<double>& edge : edges) {
+			uint64_t key = VertexPairKey(edge);
+			auto [pairIt, inserted] = pairEdges.emplace(key, keptCount);
+			if (inserted) {
+				edges[keptCount++] = edge;
+			}else if (edge.weight < edges[pairIt->second].weight) {
+				edges[pairIt->second] = edge;
+			}
+		}
+		size_t prunedCount = edges.size() - keptCount;
+		edges.resize(keptCount);
+		return prunedCount;
+	}
+
+	std::vector<graph::Edge<double>> Router::CreateAllBusEdges(const std::deque<const domain::Bus*>& buses, transport::catalog::TransportCatalogue& catalog) {
+		std::vector<std::vector<graph::Edge<double>>> routeEdges(buses.size());
+		GetThreadPool().ParallelFor(buses.size(), [&](size_t i) {
+			routeEdges[i] = CreateBusEdges(buses[i], catalog);
+		});
+		size_t edgeCount = 0;
+		for (const std::vector<graph::Edge<double>>& edges : routeEdges) {
+			edgeCount += edges.size();
+		}
+		std::vector<graph::Edge<double>> result;
+		result.reserve(edgeCount);
+		for (std::vector<graph::Edge<double>>& edges : routeEdges) {
+			result.insert(result.end(), edges.begin(), edges.end());
+			std::vector<graph::Edge<double>>().swap(edges);
+		}
+		return result;
+	}
+
+	std::vector<graph::Edge<double>> Router::CreateBusEdges(const domain::Bus* bus, transport::catalog::TransportCatalogue& catalog) {
+		size_t uniqueStopsCount = catalog.GetUniqueStopCount();
+		uint32_t busId = bus->id;
+		domain::StopIds stops = catalog.GetBusStops(*bus);
+		std::vector<graph::Edge<double>> result;
+		if (stops.empty()) {
+			return result;
+		}
+		//В свернутой модели ребро идет прямо от остановки посадки и сразу включает ожидание
+		bool folded = GetGraphModel() == GraphModel::FOLDED;
+		size_t boardingOffset = folded ? 0 : uniqueStopsCount;
+		double boardingWeight = folded ? GetSetting("bus_wait_time") : 0;
+		//Из вершины ожидания каждой остановки ребро до каждой следующей, у некольцевого маршрута еще и обратное
+		for (auto itemStopIt = stops.begin(); itemStopIt != stops.end() - 1; ++itemStopIt) {
+			double derectWeight = 0;
+			double backWeight = 0;
+			int stopCount = 0;
+			auto nextStopIt = itemStopIt + 1;
+			std::pair<uint32_t, uint32_t> stopPair{ *itemStopIt , *itemStopIt };
+			graph::VertexId departureVertextId = *itemStopIt;
+			graph::VertexId waitVertextId = *itemStopIt + boardingOffset;
+
+			while (nextStopIt != stops.end()) {
+				++stopCount;
+				stopPair.second = *nextStopIt;
+				graph::VertexId destinationVertexId = *nextStopIt;
+				graph::VertexId innerWaitVertexId = *nextStopIt + boardingOffset;
+
+				derectWeight += CalculateEdgeWeight(stopPair.first, stopPair.second, catalog);
+				result.push_back(graph::Edge<double> { waitVertextId, destinationVertexId, boardingWeight + derectWeight, graph::EdgeType::BUS, busId, stopCount });
+
+				if (!bus->loope) {
+					backWeight += CalculateEdgeWeight(stopPair.second, stopPair.first, catalog);
+					result.push_back(graph::Edge<double> { innerWaitVertexId, departureVertextId, boardingWeight + backWeight, graph::EdgeType::BUS, busId, stopCount });
+				}
+				stopPair.first = *nextStopIt;
+				++nextStopIt;
+			}
+		}
+		return result;
+	}
+
+	void Router::UpdateRoutes(transport::catalog::TransportCatalogue& catalog, const std::vector<uint32_t>& busIds) {
+		EnsureLoaded();
+		size_t uniqueStopsCount = catalog.GetUniqueStopCount();
+		GraphModel graphModel = GetGraphModel();
+		size_t vertexCount = graphModel == GraphModel::FOLDED ? uniqueStopsCount : uniqueStopsCount * 2;
+		//Новые остановки сдвигают номера вершин ожидания, а в линейной модели новый маршрут добавляет вершины - тут только полная перестройка
+		if (graphModel == GraphModel::LINEAR || graph.GetVertexCount() != vertexCount) {
+			CreateRoutes(catalog);
+			return;
+		}
+
+		//Ребро графа - самый дешевый рейс между парой вершин, поэтому ребра всех маршрутов заново сравниваются с текущими по паре вершин
+		std::unordered_map<uint64_t, graph::EdgeId> currentEdges;
+		for (graph::EdgeId edgeId = 0; edgeId < graph.GetEdgeCount(); ++edgeId) {
+			const graph::Edge<double>& edge = graph.GetEdge(edgeId);
+			if (edge.type != graph::EdgeType::BUS || graph.IsEdgeRemoved(edgeId)) {
+				continue;
+			}
+			uint64_t key = VertexPairKey(edge);
+			//В базе, собранной до отбрасывания параллельных ребер, пары повторяются - ее проще перестроить
+			if (!currentEdges.emplace(key, edgeId).second) {
+				CreateRoutes(catalog);
+				return;
+			}
+		}
+
+		std::vector<graph::Edge<double>> busEdges = CreateAllBusEdges(catalog.GetAllRoutes(), catalog);
+		prunedEdgeCount_ = PruneParallelEdges(busEdges);
+
+		//Если рейс пары сменился при том же весе, меняется только описание ребра, таблицу поправлять не нужно
+		std::vector<std::pair<graph::EdgeId, graph::Edge<double>>> increasedEdges;
+		std::vector<std::pair<graph::EdgeId, graph::Edge<double>>> decreasedEdges;
+		std::vector<std::pair<graph::EdgeId, graph::Edge<double>>> relabeledEdges;
+		std::vector<graph::EdgeId> removedEdges;
+		std::vector<graph::Edge<double>> addedEdges;
+		for (const graph::Edge<double>& edge : busEdges) {
+			auto currentIt = currentEdges.find(VertexPairKey(edge));
+			if (currentIt == currentEdges.end()) {
+				addedEdges.push_back(edge);
+				continue;
+			}
+			graph::EdgeId edgeId = currentIt->second;
+			currentEdges.erase(currentIt);
+			const graph::Edge<double>& oldEdge = graph.GetEdge(edgeId);
+			if (edge.weight > oldEdge.weight) {
+				increasedEdges.push_back({ edgeId, edge });
+			}else if (edge.weight < oldEdge.weight) {
+				decreasedEdges.push_back({ edgeId, edge });
+			}else if (edge.itemId != oldEdge.itemId || edge.stopCount != oldEdge.stopCount) {
+				relabeledEdges.push_back({ edgeId, edge });
+			}
+		}
+		for (const auto& [key, edgeId] : currentEdges) {
+			removedEdges.push_back(edgeId);
+		}
+		std::sort(removedEdges.begin(), removedEdges.end());
+
+		parallel::ThreadPool& pool = GetThreadPool();
+		graph::Router<double>* table = dynamic_cast<graph::Router<double>*>(routerFinder.get());
+		graph::Router<double, float>* floatTable = dynamic_cast<graph::Router<double, float>*>(routerFinder.get());
+		graph::Router<double, graph::FixedWeight>* fixedTable = dynamic_cast<graph::Router<double, graph::FixedWeight>*>(routerFinder.get());
+
+		//Таблица поправляется в два шага, чтобы после каждого оставаться точной: сначала ребра дорожают или удаляются, потом дешевеют или добавляются
+		std::vector<graph::EdgeId> changedEdges;
+		graph.Unfreeze();
+		for (const auto& [edgeId, edge] : relabeledEdges) {
+			graph.SetEdge(edgeId, edge);
+		}
+		for (const auto& [edgeId, edge] : increasedEdges) {
+			graph.SetEdge(edgeId, edge);
+			changedEdges.push_back(edgeId);
+		}
+		for (graph::EdgeId edgeId : removedEdges) {
+			graph.RemoveEdge(edgeId);
+			changedEdges.push_back(edgeId);
+		}
+		graph.Freeze();
+		if (table) {
+			table->RepairIncreasedEdges(changedEdges, pool);
+		}else if (floatTable) {
+			floatTable->RepairIncreasedEdges(changedEdges, pool);
+		}else if (fixedTable) {
+			fixedTable->RepairIncreasedEdges(changedEdges, pool);
+		}
+
+		changedEdges.clear();
+		double waitTime = GetSetting("bus_wait_time");
+		graph.Unfreeze();
+		for (const auto& [edgeId, edge] : decreasedEdges) {
+			graph.SetEdge(edgeId, edge);
+			changedEdges.push_back(edgeId);
+		}
+		for (uint32_t busId : busIds) {
+			const domain::Bus& bus = catalog.GetBusStorage()[busId];
+			for (uint32_t stop : catalog.GetBusStops(bus)) {
+				graph::VertexId stopVertexId = stop;
+				auto edgeExist = graph.GetIncidentEdges(stopVertexId);
+				if (graphModel != GraphModel::FOLDED && bus.stopCount > 1 && edgeExist.begin() == edgeExist.end()) {
+					changedEdges.push_back(graph.AddEdge(graph::Edge<double> { stopVertexId, stopVertexId + uniqueStopsCount, waitTime, graph::EdgeType::WAIT, static_cast<uint32_t>(stopVertexId) }));
+				}
+			}
+		}
+		for (const graph::Edge<double>& edge : addedEdges) {
+			changedEdges.push_back(graph.AddEdge(edge));
+		}
+		graph.Freeze();
+		if (table) {
+			table->RepairDecreasedEdges(changedEdges, pool);
+		}else if (floatTable) {
+			floatTable->RepairDecreasedEdges(changedEdges, pool);
+		}else if (fixedTable) {
+			fixedTable->RepairDecreasedEdges(changedEdges, pool);
+		}else {
+			CreateRouterFinder();
+		}
+		CreateComponentIndex();
+		raptor_.reset();
+	}
+
+	void Router::CreateLinearGraph(transport::catalog::TransportCatalogue& catalog) {
+		size_t uniqueStopsCount = catalog.GetUniqueStopCount();
+		const std::deque<const domain::Bus*>& allRoutes = catalog.GetAllRoutes();
+		double waitTime = GetSetting("bus_wait_time");
+
+		//У каждого маршрута своя цепочка вершин поездки, по одной на остановку, у некольцевого - еще и обратная.
+		//Первая вершина цепочки известна заранее, поэтому цепочки маршрутов строятся параллельно
+		std::vector<graph::VertexId> firstRideVertex(allRoutes.size());
+		size_t vertexCount = uniqueStopsCount;
+		for (size_t i = 0; i < allRoutes.size(); ++i) {
+			firstRideVertex[i] = vertexCount;
+			vertexCount += allRoutes[i]->stopCount * (allRoutes[i]->loope ? 1 : 2);
+		}
+		graph = graph::DirectedWeightedGraph<double>(vertexCount);
+
+		std::vector<std::vector<graph::Edge<double>>> routeEdges(allRoutes.size());
+		GetThreadPool().ParallelFor(allRoutes.size(), [&](size_t i) {
+			const domain::Bus* itemRoute = allRoutes[i];
+			uint32_t busId = itemRoute->id;
+			domain::StopIds stops = catalog.GetBusStops(*itemRoute);
+			graph::VertexId rideVertexId = firstRideVertex[i];
+			std::vector<graph::Edge<double>>& edges = routeEdges[i];
+			//Посадка стоит времени ожидания, высадка бесплатна, перегоны соединяют соседние вершины поездки
+			auto addRideChain = [&](auto begin, auto end) {
+				for (auto stopIt = begin; stopIt != end; ++stopIt, ++rideVertexId) {
+					graph::VertexId stopVertexId = *stopIt;
+					if (stopIt != begin) {
+						double rideWeight = CalculateEdgeWeight(*std::prev(stopIt), *stopIt, catalog);
+						edges.push_back(graph::Edge<double> { rideVertexId - 1, rideVertexId, rideWeight, graph::EdgeType::RIDE, busId, 1 });
+						edges.push_back(graph::Edge<double> { rideVertexId, stopVertexId, 0, graph::EdgeType::ALIGHT, busId });
+					}
+					if (std::next(stopIt) != end) {
+						edges.push_back(graph::Edge<double> { stopVertexId, rideVertexId, waitTime, graph::EdgeType::WAIT, static_cast<uint32_t>(stopVertexId) });
+					}
 				}
+			};
+			addRideChain(stops.begin(), stops.end());
+			if (!itemRoute->loope) {
+				addRideChain(std::make_reverse_iterator(stops.end()), std::make_reverse_iterator(stops.begin()));
 			}
-		}			
-		routerFinder = std::make_unique<graph::Router<double>>(graph);
+		});
+		for (std::vector<graph::Edge<double>>& edges : routeEdges) {
+			for (const graph::Edge<double>& edge : edges) {
+				graph.AddEdge(edge);
+			}
+			std::vector<graph::Edge<double>>().swap(edges);
+		}
 	}
 
-	void Router::FindRoute(const domain::Stop* from, const domain::Stop* to) {
-		std::optional<graph::Router<double>::RouteInfo> res = routerFinder->BuildRoute(from->id, to->id);			
+	void Router::FindRoute(const domain::Stop* from, const domain::Stop* to, transport::catalog::TransportCatalogue& catalog, bool timeOnly) {
+		EnsureLoaded();
+		if (!components_.IsReachable(from->id, to->id)) {
+			readyRoute.reset();
+			return;
+		}
+		if (SelectEngine() == RoutingEngine::RAPTOR) {
+			std::vector<Journey> journeys = FindJourneys(from, to, std::numeric_limits<size_t>::max(), catalog);
+			readyRoute.reset();
+			if (!journeys.empty()) {
+				readyRoute = std::move(journeys.back().trip);
+				if (timeOnly) {
+					readyRoute->items.clear();
+				}
+			}
+			return;
+		}
+		if (timeOnly) {
+			std::optional<double> totalTime = routerFinder->GetRouteWeight(from->id, to->id);
+			readyRoute.reset();
+			if (totalTime.has_value()) {
+				readyRoute = domain::Trip{ totalTime.value(), {} };
+			}
+			return;
+		}
+
+		std::optional<graph::RouteFinder<double>::RouteInfo> res = routerFinder->BuildRoute(from->id, to->id);			
 		readyRoute.reset();
 		if (res.has_value()) {
 			domain::Trip result;
 			std::vector<graph::EdgeId> edgeIds = res.value().edges;				
+			const std::vector<domain::Stop>& stops = catalog.GetStopStorage();
+			const std::vector<domain::Bus>& buses = catalog.GetBusStorage();
+			//В свернутой модели ожидание восстанавливается из ребра поездки, остановка посадки - его начало
+			bool folded = GetGraphModel() == GraphModel::FOLDED;
+			double waitTime = GetSetting("bus_wait_time");
+			//В линейной модели подряд идущие перегоны одного маршрута собираются в одну поездку до высадки
+			bool riding = false;
 			for (const graph::EdgeId& itemEdgeId : edgeIds) {
-				const graph::Edge edge = graph.GetEdge(itemEdgeId);
+				const graph::Edge<double>& edge = graph.GetEdge(itemEdgeId);
 				result.totalTime += edge.weight;
-				result.items.push_back({edge.type, edge.weight, edge.name, edge.stopCount});
+				if (edge.type == graph::EdgeType::WAIT) {
+					result.items.push_back({"Wait", edge.weight, stops[edge.itemId].name, edge.stopCount});
+				}else if (edge.type == graph::EdgeType::BUS && folded) {
+					result.items.push_back({"Wait", waitTime, stops[edge.from].name, 0});
+					result.items.push_back({"Bus", edge.weight - waitTime, buses[edge.itemId].name, edge.stopCount});
+				}else if (edge.type == graph::EdgeType::BUS) {
+					result.items.push_back({"Bus", edge.weight, buses[edge.itemId].name, edge.stopCount});
+				}else if (edge.type == graph::EdgeType::RIDE && riding) {
+					result.items.back().time += edge.weight;
+					result.items.back().spanCount += edge.stopCount;
+				}else if (edge.type == graph::EdgeType::RIDE) {
+					result.items.push_back({"Bus", edge.weight, buses[edge.itemId].name, edge.stopCount});
+				}
+				riding = edge.type == graph::EdgeType::RIDE;
 			}
 			readyRoute = std::move(result);
 		}						
@@ -104,5 +690,58 @@ namespace route {
 	const std::optional<domain::Trip>& Router::GetReadyRoute()const {
 		return readyRoute;
 	}
+
+	const Raptor& Router::GetRaptor(transport::catalog::TransportCatalogue& catalog) {
+		std::lock_guard lock(raptorMutex_);
+		if (!raptor_) {
+			raptor_ = std::make_unique<Raptor>(catalog, GetSetting("bus_wait_time"), GetSetting("bus_velocity"));
+		}
+		return *raptor_;
+	}
+
+	std::vector<Journey> Router::FindJourneys(const domain::Stop* from, const domain::Stop* to, size_t maxTransfers,
+		transport::catalog::TransportCatalogue& catalog) {
+		EnsureLoaded();
+		if (!components_.IsReachable(from->id, to->id)) {
+			return {};
+		}
+		return GetRaptor(catalog).FindJourneys(from, to, maxTransfers);
+	}
+
+	std::vector<std::vector<std::optional<double>>> Router::BuildRouteMatrix(const std::vector<const domain::Stop*>& from,
+		const std::vector<const domain::Stop*>& to) {
+		EnsureLoaded();
+		std::vector<graph::VertexId> sources;
+		std::vector<graph::VertexId> targets;
+		sources.reserve(from.size());
+		targets.reserve(to.size());
+		for (const domain::Stop* stop : from) {
+			sources.push_back(stop->id);
+		}
+		for (const domain::Stop* stop : to) {
+			targets.push_back(stop->id);
+		}
+
+		//Таблица всех пар и хабовые метки отвечают на пару быстрее, чем Дейкстра до всех целей, для остальных движков - один проход от каждого источника
+		const graph::RouteFinder<double>* finder = nullptr;
+		if (GetAllPairsRouter<double>() || GetAllPairsRouter<float>() || GetAllPairsRouter<graph::FixedWeight>() || GetHubLabels()) {
+			finder = routerFinder.get();
+		}
+		return graph::ComputeRouteMatrix(graph, sources, targets, finder, GetThreadPool());
+	}
+
+	std::vector<std::pair<const domain::Stop*, double>> Router::FindReachableStops(const domain::Stop* from, double maxTime,
+		transport::catalog::TransportCatalogue& catalog) {
+		EnsureLoaded();
+		const std::vector<domain::Stop>& stops = catalog.GetStopStorage();
+		std::vector<std::pair<const domain::Stop*, double>> result;
+		//Вершины остановок в обеих моделях графа имеют номера id остановок, остальные вершины пропускаются
+		for (const auto& [vertex, weight] : graph::ComputeReachableWeights(graph, from->id, maxTime)) {
+			if (vertex < stops.size()) {
+				result.push_back({ &stops[vertex], weight });
+			}
+		}
+		return result;
+	}
 }
 }
\ No newline at end of file